@@ -8,6 +8,88 @@
 #define FPGA_HW
 #endif
 
+// number of independent subtrees ( = orchestrator, hash engine kernel pairs )
+// tree is split into, which can be raised when FPGA has enough area, by
+// compiling with -DSUBTREE_CNT=N, where N is power of 2
+#if !defined SUBTREE_CNT
+#define SUBTREE_CNT 2
+#endif
+
+// log2 of leaf count of each tile, whose subtree is computed in on-chip memory
+// by subtree orchestrators, see `merklize::merklize`, which can be enabled by
+// compiling with -DSUBTREE_TILE_LOG=k, where k > 0
+#if !defined SUBTREE_TILE_LOG
+#define SUBTREE_TILE_LOG 0
+#endif
+
+// benchmark binary instantiates hash engines of every merklization mode & of
+// batched hashing, which is more than a dozen of them, while with fully
+// unrolled engines ( -DSHA256_UNROLLED ) only few fit on board, so compiling
+// with -DBENCH_MERKLIZE_ONLY keeps just first table, benchmarking
+// `merklize::merklize` with SUBTREE_CNT subtrees, dropping all other ones
+
+// number of systolic stages ( = stage, hash engine kernel pairs ), computing
+// lowest levels of tree, one level each, see `merklize::merklize_systolic`,
+// which can be set by compiling with -DSYSTOLIC_STAGE_CNT=S, where S <= 20
+#if !defined SYSTOLIC_STAGE_CNT
+#define SYSTOLIC_STAGE_CNT 4
+#endif
+
+// number of chunks leaves are transferred to device in, while overlapping
+// transfer with computation, which can be set by compiling with
+// -DSTREAM_CHUNK_CNT=N, where N is power of 2 & >= 2
+#if !defined STREAM_CHUNK_CNT
+#define STREAM_CHUNK_CNT 16
+#endif
+
+// number of top levels of tree ( K ) to be computed & transferred back to host,
+// while lower levels are computed in on-chip memory, in tiles of 2^T leaves,
+// which can be set by compiling with -DTOP_LEVEL_CNT=K -DTOP_LEVEL_TILE_LOG=T,
+// where 2^(K-1) >= SUBTREE_CNT & T > 0
+#if !defined TOP_LEVEL_CNT
+#define TOP_LEVEL_CNT 16
+#endif
+
+#if !defined TOP_LEVEL_TILE_LOG
+#define TOP_LEVEL_TILE_LOG 4
+#endif
+
+// number of inclusion proofs gathered from resident tree ( or verified ), in a
+// batch, which can be set by compiling with -DPROOF_CNT=N
+#if !defined PROOF_CNT
+#define PROOF_CNT (1ul << 20)
+#endif
+
+// Benchmarks batched SHA256 hashing of independent `msg_len` -bytes messages &
+// prints average execution/ data transfer time, along with throughput
+template<size_t msg_len>
+void
+print_hash_batch_bench(sycl::queue& q, const size_t itr_cnt, double* const ts)
+{
+  std::cout << std::endl
+            << "Benchmarking batched SHA256 hashing of independent " << msg_len
+            << " -bytes messages" << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "message count"
+            << "\t\t" << std::setw(16) << std::right << "execution time"
+            << "\t\t" << std::setw(16) << std::right << "throughput"
+            << "\t\t" << std::setw(16) << std::right << "host-to-device tx time"
+            << "\t\t" << std::setw(16) << std::right << "device-to-host tx time"
+            << std::endl;
+
+  for (size_t i = 20; i <= 24; i++) {
+    avg_hash_batch_exec_tm<msg_len>(q, 1ul << i, itr_cnt, ts);
+
+    std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(ts[1])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_throughput(1ul << i, ts[1]) << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(ts[0])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(ts[2]) << std::endl;
+  }
+}
+
 int
 main(int argc, char** argv)
 {
@@ -28,8 +110,9 @@ main(int argc, char** argv)
   constexpr size_t itr_cnt = 8;
   double* ts = static_cast<double*>(std::malloc(sizeof(double) * 3));
 
-  std::cout << "Benchmarking SHA256 Binary Merklization FPGA implementation"
-            << std::endl
+  std::cout << "Benchmarking SHA256 Binary Merklization FPGA implementation, "
+            << "using " << SUBTREE_CNT << " subtree(s), tile log "
+            << SUBTREE_TILE_LOG << std::endl
             << std::endl;
   std::cout << std::setw(16) << std::right << "leaf count"
             << "\t\t" << std::setw(16) << std::right << "execution time"
@@ -38,7 +121,8 @@ main(int argc, char** argv)
             << std::endl;
 
   for (size_t i = 20; i <= 25; i++) {
-    avg_kernel_exec_tm(q, 1ul << i, itr_cnt, ts);
+    avg_kernel_exec_tm<SUBTREE_CNT, SUBTREE_TILE_LOG>(
+      q, 1ul << i, itr_cnt, ts);
 
     std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
               << std::setw(22) << std::right << to_readable_timespan(ts[1])
@@ -47,6 +131,178 @@ main(int argc, char** argv)
               << std::right << to_readable_timespan(ts[2]) << std::endl;
   }
 
+#if !defined BENCH_MERKLIZE_ONLY
+  std::cout << std::endl
+            << "Benchmarking SHA256 Binary Merklization FPGA implementation, "
+            << "using " << SYSTOLIC_STAGE_CNT << " systolic stage(s)"
+            << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "leaf count"
+            << "\t\t" << std::setw(16) << std::right << "execution time"
+            << "\t\t" << std::setw(16) << std::right << "host-to-device tx time"
+            << "\t\t" << std::setw(16) << std::right << "device-to-host tx time"
+            << std::endl;
+
+  for (size_t i = 20; i <= 25; i++) {
+    sycl::cl_ulong tm[3];
+
+    benchmark_merklize_systolic<SYSTOLIC_STAGE_CNT>(q, 1ul << i, tm);
+
+    std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(tm[1])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(tm[0]) << "\t\t" << std::setw(22)
+              << std::right << to_readable_timespan(tm[2]) << std::endl;
+  }
+
+  std::cout << std::endl
+            << "Benchmarking SHA256 Binary Merklization FPGA implementation, "
+            << "with pageable, pinned & zero-copy host memory" << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "leaf count"
+            << "\t\t" << std::setw(16) << std::right
+            << "pageable ( tx + exec )"
+            << "\t\t" << std::setw(16) << std::right << "pinned ( tx + exec )"
+            << "\t\t" << std::setw(16) << std::right << "zero-copy ( exec )"
+            << std::endl;
+
+  for (size_t i = 20; i <= 25; i++) {
+    double tm[3];
+
+    avg_kernel_exec_tm<SUBTREE_CNT, SUBTREE_TILE_LOG, host_mem::pageable>(
+      q, 1ul << i, itr_cnt, ts);
+    tm[0] = ts[0] + ts[1];
+
+    avg_kernel_exec_tm<SUBTREE_CNT, SUBTREE_TILE_LOG, host_mem::pinned>(
+      q, 1ul << i, itr_cnt, ts);
+    tm[1] = ts[0] + ts[1];
+
+    avg_kernel_exec_tm<SUBTREE_CNT, SUBTREE_TILE_LOG, host_mem::zero_copy>(
+      q, 1ul << i, itr_cnt, ts);
+    tm[2] = ts[1];
+
+    std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(tm[0])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(tm[1]) << "\t\t" << std::setw(22)
+              << std::right << to_readable_timespan(tm[2]) << std::endl;
+  }
+
+  std::cout << std::endl
+            << "Benchmarking SHA256 Binary Merklization FPGA implementation, "
+            << "with leaves streamed in " << STREAM_CHUNK_CNT << " chunks"
+            << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "leaf count"
+            << "\t\t" << std::setw(16) << std::right
+            << "host-to-device tx + execution time"
+            << "\t\t" << std::setw(16) << std::right << "device-to-host tx time"
+            << std::endl;
+
+  for (size_t i = 20; i <= 25; i++) {
+    avg_streamed_exec_tm(q, 1ul << i, STREAM_CHUNK_CNT, itr_cnt, ts);
+
+    std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
+              << std::setw(34) << std::right << to_readable_timespan(ts[0])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(ts[1]) << std::endl;
+  }
+
+  std::cout << std::endl
+            << "Benchmarking SHA256 Binary Merklization FPGA implementation, "
+            << "using persistent context" << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "leaf count"
+            << "\t\t" << std::setw(16) << std::right << "first call latency"
+            << "\t\t" << std::setw(16) << std::right
+            << "steady-state latency" << std::endl;
+
+  for (size_t i = 20; i <= 25; i++) {
+    benchmark_context<SUBTREE_CNT, SUBTREE_TILE_LOG>(q, 1ul << i, itr_cnt, ts);
+
+    std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(ts[0])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(ts[1]) << std::endl;
+  }
+
+  std::cout << std::endl
+            << "Benchmarking SHA256 Binary Merklization FPGA implementation, "
+            << "computing only top " << TOP_LEVEL_CNT << " levels" << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "leaf count"
+            << "\t\t" << std::setw(16) << std::right << "execution time"
+            << "\t\t" << std::setw(16) << std::right << "host-to-device tx time"
+            << "\t\t" << std::setw(16) << std::right << "device-to-host tx time"
+            << std::endl;
+
+  for (size_t i = 20; i <= 25; i++) {
+    sycl::cl_ulong tm[3];
+
+    benchmark_merklize_top_levels<SUBTREE_CNT, TOP_LEVEL_TILE_LOG>(
+      q, 1ul << i, TOP_LEVEL_CNT, tm);
+
+    std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(tm[1])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(tm[0]) << "\t\t" << std::setw(22)
+              << std::right << to_readable_timespan(tm[2]) << std::endl;
+  }
+
+  std::cout << std::endl
+            << "Benchmarking inclusion proof extraction from resident binary "
+            << "merkle tree, for " << PROOF_CNT << " random leaves" << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "leaf count"
+            << "\t\t" << std::setw(16) << std::right << "execution time"
+            << "\t\t" << std::setw(16) << std::right << "throughput"
+            << "\t\t" << std::setw(16) << std::right << "host-to-device tx time"
+            << "\t\t" << std::setw(16) << std::right << "device-to-host tx time"
+            << std::endl;
+
+  for (size_t i = 20; i <= 25; i++) {
+    sycl::cl_ulong tm[3];
+
+    benchmark_extract_proofs(q, 1ul << i, PROOF_CNT, tm);
+
+    std::cout << std::setw(10) << std::right << 2 << " ^ " << i << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(tm[1])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_throughput(PROOF_CNT, tm[1]) << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(tm[0])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(tm[2]) << std::endl;
+  }
+
+  std::cout << std::endl
+            << "Benchmarking inclusion proof verification, for " << PROOF_CNT
+            << " proofs" << std::endl
+            << std::endl;
+  std::cout << std::setw(16) << std::right << "proof depth"
+            << "\t\t" << std::setw(16) << std::right << "execution time"
+            << "\t\t" << std::setw(16) << std::right << "throughput"
+            << "\t\t" << std::setw(16) << std::right << "host-to-device tx time"
+            << "\t\t" << std::setw(16) << std::right << "device-to-host tx time"
+            << std::endl;
+
+  for (size_t i = 20; i <= 25; i++) {
+    sycl::cl_ulong tm[3];
+
+    benchmark_verify_proofs(q, i, PROOF_CNT, tm);
+
+    std::cout << std::setw(16) << std::right << i << "\t\t" << std::setw(22)
+              << std::right << to_readable_timespan(tm[1]) << "\t\t"
+              << std::setw(22) << std::right
+              << to_readable_throughput(PROOF_CNT, tm[1]) << "\t\t"
+              << std::setw(22) << std::right << to_readable_timespan(tm[0])
+              << "\t\t" << std::setw(22) << std::right
+              << to_readable_timespan(tm[2]) << std::endl;
+  }
+
+  print_hash_batch_bench<64>(q, itr_cnt, ts);
+  print_hash_batch_bench<32>(q, itr_cnt, ts);
+#endif
+
   std::free(ts);
 
   return EXIT_SUCCESS;
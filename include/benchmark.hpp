@@ -1,5 +1,27 @@
 #pragma once
+#include "context.hpp"
+#include "hash_batch.hpp"
 #include "merklize.hpp"
+#include "merklize_proof.hpp"
+#include "merklize_streamed.hpp"
+#include "merklize_systolic.hpp"
+#include "merklize_top.hpp"
+#include <chrono>
+#include <random>
+
+// Kind of host memory, leaves & intermediates are kept in, while benchmarking
+// binary merklization
+//
+// - pageable  : `std::malloc` -ed, transferred to/ from device
+// - pinned    : `sycl::malloc_host` -ed, transferred to/ from device
+// - zero_copy : `sycl::malloc_host` -ed, leaves read by kernels directly over
+//               PCIe, while intermediates are transferred back
+enum class host_mem
+{
+  pageable,
+  pinned,
+  zero_copy
+};
 
 // For given many leaf nodes of some binary merkle tree, computes all
 // intermediates on accelerator, while input leaves are explicitly
@@ -14,7 +36,13 @@
 // - kernel exec time
 // - device -> host data tx time
 //
+// Intermediates are computed using N independent subtrees, each in tiles of
+// 2^TILE_LOG leaves ( when non-zero ), see `merklize::merklize`, while leaves
+// and intermediates are kept in host memory of kind `mem`. With zero-copy
+// mode, there's no host -> device data tx, so its time is reported as 0.
+//
 // Note, ensure that queue has profiling enabled
+template<size_t N, size_t TILE_LOG = 0, host_mem mem = host_mem::pageable>
 void
 benchmark_merklize(sycl::queue& q,
                    const size_t leaf_cnt,
@@ -23,31 +51,55 @@ benchmark_merklize(sycl::queue& q,
   const size_t i_size = leaf_cnt << 5;
   const size_t o_size = i_size;
 
+  constexpr bool pageable = mem == host_mem::pageable;
+  constexpr bool zero_copy = mem == host_mem::zero_copy;
+
+  auto malloc_host = [&](const size_t size) {
+    return static_cast<uint32_t*>(pageable ? std::malloc(size)
+                                           : sycl::malloc_host(size, q));
+  };
+
+  auto free_host = [&](uint32_t* const ptr) {
+    if constexpr (pageable) {
+      std::free(ptr);
+    } else {
+      sycl::free(ptr, q);
+    }
+  };
+
   // acquire resources
-  uint32_t* i_d = static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* i_d = zero_copy
+                    ? nullptr
+                    : static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
   uint32_t* o_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
-  uint32_t* i_h = static_cast<uint32_t*>(std::malloc(i_size));
-  uint32_t* o_h = static_cast<uint32_t*>(std::malloc(o_size));
+  uint32_t* i_h = malloc_host(i_size);
+  uint32_t* o_h = malloc_host(o_size);
 
   memset(i_h, 0xff, i_size);
 
-  sycl::event evt0 = q.memcpy(i_d, i_h, i_size);
-  evt0.wait();
+  // all commands are chained on device, so host waits only once
+  std::vector<sycl::event> evts;
+  std::vector<sycl::event> deps;
 
-  // waiting for completion of computation of all intermediates
-  sycl::cl_ulong tm = merklize::merklize(q, leaf_cnt, i_d, i_size, o_d, o_size);
+  if constexpr (!zero_copy) {
+    deps.push_back(q.memcpy(i_d, i_h, i_size));
+  }
 
-  sycl::event evt1 = q.memcpy(o_h, o_d, o_size);
+  sycl::event evt = merklize::merklize_async<N, TILE_LOG, zero_copy>(
+    q, leaf_cnt, zero_copy ? i_h : i_d, i_size, o_d, o_size, deps, &evts);
+  sycl::event evt1 = q.memcpy(o_h, o_d, o_size, evt);
   evt1.wait();
 
   // release resources
-  sycl::free(i_d, q);
+  if constexpr (!zero_copy) {
+    sycl::free(i_d, q);
+  }
   sycl::free(o_d, q);
-  std::free(i_h);
-  std::free(o_h);
+  free_host(i_h);
+  free_host(o_h);
 
-  ts[0] = time_event(evt0);
-  ts[1] = tm;
+  ts[0] = zero_copy ? 0 : time_event(deps[0]);
+  ts[1] = merklize::exec_time<N>(evts);
   ts[2] = time_event(evt1);
 }
 
@@ -57,6 +109,9 @@ benchmark_merklize(sycl::queue& q,
 // - host -> device input tx time
 // - kernel execution time
 // - device -> host output tx time
+//
+// Leaves & intermediates are kept in host memory of kind `mem`
+template<size_t N, size_t TILE_LOG = 0, host_mem mem = host_mem::pageable>
 void
 avg_kernel_exec_tm(sycl::queue& q,
                    const size_t leaf_cnt,
@@ -73,7 +128,7 @@ avg_kernel_exec_tm(sycl::queue& q,
   std::memset(ts_sum, 0, ts_size);
 
   for (size_t i = 0; i < itr_cnt; i++) {
-    benchmark_merklize(q, leaf_cnt, ts_rnd);
+    benchmark_merklize<N, TILE_LOG, mem>(q, leaf_cnt, ts_rnd);
 
     ts_sum[0] += ts_rnd[0];
     ts_sum[1] += ts_rnd[1];
@@ -89,6 +144,444 @@ avg_kernel_exec_tm(sycl::queue& q,
   std::free(ts_rnd);
 }
 
+// For given many leaf nodes of some binary merkle tree, computes all
+// intermediates on accelerator, using S systolic stages, see
+// `merklize::merklize_systolic`, while input leaves are explicitly transferred
+// from host to device over PCIe & after completion of computation of all
+// intermediates, those are transferred back to host over PCIe interface
+//
+// Last parameter of this function will return execution time of three
+// operations, in following order
+//
+// - host -> device data tx time
+// - kernel exec time ( span of all stages & reduction kernel )
+// - device -> host data tx time
+//
+// Note, ensure that queue has profiling enabled
+template<size_t S>
+void
+benchmark_merklize_systolic(sycl::queue& q,
+                            const size_t leaf_cnt,
+                            sycl::cl_ulong* const ts)
+{
+  const size_t i_size = leaf_cnt << 5;
+  const size_t o_size = i_size;
+
+  // acquire resources
+  uint32_t* i_d = static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* o_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+  uint32_t* i_h = static_cast<uint32_t*>(std::malloc(i_size));
+  uint32_t* o_h = static_cast<uint32_t*>(std::malloc(o_size));
+
+  memset(i_h, 0xff, i_size);
+
+  sycl::event evt0 = q.memcpy(i_d, i_h, i_size);
+  evt0.wait();
+
+  // waiting for completion of all stages & reduction kernel
+  sycl::cl_ulong tm = merklize::merklize_systolic<S>(
+    q, leaf_cnt, i_d, i_size, o_d, o_size);
+
+  sycl::event evt1 = q.memcpy(o_h, o_d, o_size);
+  evt1.wait();
+
+  // release resources
+  sycl::free(i_d, q);
+  sycl::free(o_d, q);
+  std::free(i_h);
+  std::free(o_h);
+
+  ts[0] = time_event(evt0);
+  ts[1] = tm;
+  ts[2] = time_event(evt1);
+}
+
+// For given many leaf nodes of some binary merkle tree, computes all
+// intermediates on accelerator, while input leaves are transferred from host
+// to device in `chunk_cnt` chunks, overlapped with computation, see
+// `merklize::merklize_streamed`, & after completion of computation of all
+// intermediates, those are transferred back to host over PCIe interface
+//
+// Last parameter of this function will return execution time of two
+// operations, in following order
+//
+// - host -> device data tx time + kernel exec time ( overlapped )
+// - device -> host data tx time
+//
+// Note, ensure that queue has profiling enabled
+void
+benchmark_merklize_streamed(sycl::queue& q,
+                            const size_t leaf_cnt,
+                            const size_t chunk_cnt,
+                            sycl::cl_ulong* const ts)
+{
+  const size_t i_size = leaf_cnt << 5;
+  const size_t o_size = i_size;
+
+  // acquire resources
+  uint32_t* o_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+  uint32_t* i_h = static_cast<uint32_t*>(std::malloc(i_size));
+  uint32_t* o_h = static_cast<uint32_t*>(std::malloc(o_size));
+
+  memset(i_h, 0xff, i_size);
+
+  // waiting for completion of computation of all intermediates
+  sycl::cl_ulong tm = merklize::merklize_streamed(
+    q, leaf_cnt, i_h, i_size, o_d, o_size, chunk_cnt);
+
+  sycl::event evt = q.memcpy(o_h, o_d, o_size);
+  evt.wait();
+
+  // release resources
+  sycl::free(o_d, q);
+  std::free(i_h);
+  std::free(o_h);
+
+  ts[0] = tm;
+  ts[1] = time_event(evt);
+}
+
+// Executes SHA256 binary merklization kernels, with leaves streamed in
+// `chunk_cnt` chunks, with same input size `itr_cnt` -many times and computes
+// average execution time of following SYCL commands
+//
+// - host -> device input tx time + kernel execution time ( overlapped )
+// - device -> host output tx time
+void
+avg_streamed_exec_tm(sycl::queue& q,
+                     const size_t leaf_cnt,
+                     const size_t chunk_cnt,
+                     const size_t itr_cnt,
+                     double* const ts)
+{
+  sycl::cl_ulong ts_sum[2] = { 0, 0 };
+  sycl::cl_ulong ts_rnd[2];
+
+  for (size_t i = 0; i < itr_cnt; i++) {
+    benchmark_merklize_streamed(q, leaf_cnt, chunk_cnt, ts_rnd);
+
+    ts_sum[0] += ts_rnd[0];
+    ts_sum[1] += ts_rnd[1];
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    ts[i] = (double)ts_sum[i] / (double)itr_cnt;
+  }
+}
+
+// Computes all intermediates of binary merkle tree with `leaf_cnt` leaves,
+// `itr_cnt` ( >= 2 ) -many times, using same merklization context, measuring
+// end-to-end latency ( as seen by host, including allocations & transfers ) of
+// each call, see `merklize::context`
+//
+// Last parameter of this function will return two latencies, in following
+// order
+//
+// - first call, which allocates all pooled buffers
+// - average of subsequent ( steady-state ) calls, reusing pooled buffers
+//
+// Note, ensure that queue has profiling enabled
+template<size_t N, size_t TILE_LOG = 0>
+void
+benchmark_context(sycl::queue& q,
+                  const size_t leaf_cnt,
+                  const size_t itr_cnt,
+                  double* const ts)
+{
+  using namespace std::chrono;
+
+  assert(itr_cnt >= 2);
+
+  const size_t size = leaf_cnt << 5;
+
+  merklize::context ctx{ q };
+  sycl::cl_ulong ts_rnd[3];
+  double ts_sum = 0;
+
+  for (size_t i = 0; i < itr_cnt; i++) {
+    const auto start = steady_clock::now();
+
+    uint32_t* i_h = ctx.acquire_host(size);
+    uint32_t* o_h = ctx.acquire_host(size);
+
+    ctx.merklize<N, TILE_LOG>(leaf_cnt, i_h, o_h, ts_rnd);
+
+    ctx.release(i_h);
+    ctx.release(o_h);
+
+    const auto end = steady_clock::now();
+    const double tm = duration_cast<nanoseconds>(end - start).count();
+
+    if (i == 0) {
+      ts[0] = tm;
+    } else {
+      ts_sum += tm;
+    }
+  }
+
+  ts[1] = ts_sum / (double)(itr_cnt - 1);
+}
+
+// For given many leaf nodes of some binary merkle tree, computes only top K
+// levels of tree on accelerator, see `merklize::merklize_top_levels`, while
+// input leaves are explicitly transferred from host to device over PCIe & after
+// completion of computation, only top K levels are transferred back to host
+//
+// Last parameter of this function will return execution time of three
+// operations, in following order
+//
+// - host -> device data tx time
+// - kernel exec time
+// - device -> host data tx time
+//
+// Note, ensure that queue has profiling enabled
+template<size_t N, size_t TILE_LOG>
+void
+benchmark_merklize_top_levels(sycl::queue& q,
+                              const size_t leaf_cnt,
+                              const size_t K,
+                              sycl::cl_ulong* const ts)
+{
+  const size_t i_size = leaf_cnt << 5;
+  const size_t o_size = (1ul << K) << 5;
+
+  // acquire resources
+  uint32_t* i_d = static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* o_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+  uint32_t* i_h = static_cast<uint32_t*>(std::malloc(i_size));
+  uint32_t* o_h = static_cast<uint32_t*>(std::malloc(o_size));
+
+  memset(i_h, 0xff, i_size);
+
+  sycl::event evt0 = q.memcpy(i_d, i_h, i_size);
+  evt0.wait();
+
+  // waiting for completion of computation of top levels
+  sycl::cl_ulong tm = merklize::merklize_top_levels<N, TILE_LOG>(
+    q, leaf_cnt, i_d, i_size, o_d, o_size, K);
+
+  sycl::event evt1 = merklize::read_top_levels(q, o_d, o_h, K);
+  evt1.wait();
+
+  // release resources
+  sycl::free(i_d, q);
+  sycl::free(o_d, q);
+  std::free(i_h);
+  std::free(o_h);
+
+  ts[0] = time_event(evt0);
+  ts[1] = tm;
+  ts[2] = time_event(evt1);
+}
+
+// For binary merkle tree with `leaf_cnt` leaves, resident in device memory,
+// gathers inclusion proofs of `proof_cnt` -many random leaves on accelerator,
+// while leaf indices are explicitly transferred from host to device over PCIe
+// & after completion of gathering, only proofs are transferred back to host
+//
+// Last parameter of this function will return execution time of three
+// operations, in following order
+//
+// - host -> device data tx time
+// - kernel exec time
+// - device -> host data tx time
+//
+// Note, ensure that queue has profiling enabled
+void
+benchmark_extract_proofs(sycl::queue& q,
+                         const size_t leaf_cnt,
+                         const size_t proof_cnt,
+                         sycl::cl_ulong* const ts)
+{
+  const size_t size = leaf_cnt << 5;
+  const size_t i_size = proof_cnt * sizeof(size_t);
+  const size_t o_size = (proof_cnt * merklize::bin_log(leaf_cnt)) << 5;
+
+  // acquire resources
+  uint32_t* l_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* m_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  size_t* i_d = static_cast<size_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* o_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+  size_t* i_h = static_cast<size_t*>(std::malloc(i_size));
+  uint32_t* o_h = static_cast<uint32_t*>(std::malloc(o_size));
+
+  // make tree resident in device memory
+  q.memset(l_d, 0xff, size).wait();
+  merklize::merklize<1>(q, leaf_cnt, l_d, size, m_d, size);
+
+  std::mt19937_64 rng{ leaf_cnt };
+  for (size_t i = 0; i < proof_cnt; i++) {
+    i_h[i] = rng() & (leaf_cnt - 1);
+  }
+
+  sycl::event evt0 = q.memcpy(i_d, i_h, i_size);
+  sycl::event evt1 = merklize::extract_proofs_async(
+    q, leaf_cnt, l_d, m_d, i_d, proof_cnt, o_d, { evt0 });
+  sycl::event evt2 = q.memcpy(o_h, o_d, o_size, evt1);
+  evt2.wait();
+
+  // release resources
+  sycl::free(l_d, q);
+  sycl::free(m_d, q);
+  sycl::free(i_d, q);
+  sycl::free(o_d, q);
+  std::free(i_h);
+  std::free(o_h);
+
+  ts[0] = time_event(evt0);
+  ts[1] = time_event(evt1);
+  ts[2] = time_event(evt2);
+}
+
+// Verifies `proof_cnt` -many random inclusion proofs, each of `depth` sibling
+// digests, on accelerator, while ( leaf, proof, index, root ) tuples are
+// explicitly transferred from host to device over PCIe & after completion of
+// verification, only pass/ fail bitmap is transferred back to host
+//
+// Last parameter of this function will return execution time of three
+// operations, in following order
+//
+// - host -> device data tx time
+// - kernel exec time
+// - device -> host data tx time
+//
+// Note, ensure that queue has profiling enabled
+void
+benchmark_verify_proofs(sycl::queue& q,
+                        const size_t depth,
+                        const size_t proof_cnt,
+                        sycl::cl_ulong* const ts)
+{
+  const size_t d_size = proof_cnt << 5;
+  const size_t p_size = (proof_cnt * depth) << 5;
+  const size_t i_size = proof_cnt * sizeof(size_t);
+  const size_t b_size = ((proof_cnt + 31) >> 5) << 2;
+
+  // acquire resources
+  uint32_t* l_d = static_cast<uint32_t*>(sycl::malloc_device(d_size, q));
+  uint32_t* p_d = static_cast<uint32_t*>(sycl::malloc_device(p_size, q));
+  size_t* i_d = static_cast<size_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* r_d = static_cast<uint32_t*>(sycl::malloc_device(d_size, q));
+  uint32_t* t_d = static_cast<uint32_t*>(sycl::malloc_device(d_size, q));
+  uint32_t* b_d = static_cast<uint32_t*>(sycl::malloc_device(b_size, q));
+  uint32_t* p_h = static_cast<uint32_t*>(std::malloc(p_size));
+  uint32_t* b_h = static_cast<uint32_t*>(std::malloc(b_size));
+
+  memset(p_h, 0xff, p_size);
+  q.memset(l_d, 0xff, d_size).wait();
+  q.memset(i_d, 0x5a, i_size).wait();
+  q.memset(r_d, 0xff, d_size).wait();
+
+  sycl::event evt0 = q.memcpy(p_d, p_h, p_size);
+  sycl::event evt1 = merklize::verify_proofs_async(
+    q, depth, l_d, p_d, i_d, r_d, proof_cnt, t_d, b_d, { evt0 });
+  sycl::event evt2 = q.memcpy(b_h, b_d, b_size, evt1);
+  evt2.wait();
+
+  // release resources
+  sycl::free(l_d, q);
+  sycl::free(p_d, q);
+  sycl::free(i_d, q);
+  sycl::free(r_d, q);
+  sycl::free(t_d, q);
+  sycl::free(b_d, q);
+  std::free(p_h);
+  std::free(b_h);
+
+  ts[0] = time_event(evt0);
+  ts[1] = time_event(evt1);
+  ts[2] = time_event(evt2);
+}
+
+// For given many independent `msg_len` -bytes messages, computes their SHA256
+// digests on accelerator, while input messages are explicitly transferred from
+// host to device over PCIe & after completion of computation, digests are
+// transferred back to host over PCIe interface
+//
+// Last parameter of this function will return execution time of three
+// operations, in following order
+//
+// - host -> device data tx time
+// - kernel exec time
+// - device -> host data tx time
+//
+// Note, ensure that queue has profiling enabled
+template<size_t msg_len = 64>
+void
+benchmark_hash_batch(sycl::queue& q,
+                     const size_t msg_cnt,
+                     sycl::cl_ulong* const ts)
+{
+  const size_t i_size = msg_cnt * msg_len;
+  const size_t o_size = msg_cnt << 5;
+
+  // acquire resources
+  uint32_t* i_d = static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* o_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+  uint32_t* i_h = static_cast<uint32_t*>(std::malloc(i_size));
+  uint32_t* o_h = static_cast<uint32_t*>(std::malloc(o_size));
+
+  memset(i_h, 0xff, i_size);
+
+  sycl::event evt0 = q.memcpy(i_d, i_h, i_size);
+  sycl::event evt1 =
+    sha256::hash_batch<msg_len>(q, i_d, o_d, msg_cnt, { evt0 });
+  sycl::event evt2 = q.memcpy(o_h, o_d, o_size, evt1);
+  evt2.wait();
+
+  // release resources
+  sycl::free(i_d, q);
+  sycl::free(o_d, q);
+  std::free(i_h);
+  std::free(o_h);
+
+  ts[0] = time_event(evt0);
+  ts[1] = time_event(evt1);
+  ts[2] = time_event(evt2);
+}
+
+// Executes batched SHA256 hashing kernels with same input size `itr_cnt`
+// -many times and computes average execution time of following SYCL commands
+//
+// - host -> device input tx time
+// - kernel execution time
+// - device -> host output tx time
+template<size_t msg_len = 64>
+void
+avg_hash_batch_exec_tm(sycl::queue& q,
+                       const size_t msg_cnt,
+                       const size_t itr_cnt,
+                       double* const ts)
+{
+  sycl::cl_ulong ts_sum[3] = { 0, 0, 0 };
+  sycl::cl_ulong ts_rnd[3];
+
+  for (size_t i = 0; i < itr_cnt; i++) {
+    benchmark_hash_batch<msg_len>(q, msg_cnt, ts_rnd);
+
+    ts_sum[0] += ts_rnd[0];
+    ts_sum[1] += ts_rnd[1];
+    ts_sum[2] += ts_rnd[2];
+  }
+
+  for (size_t i = 0; i < 3; i++) {
+    ts[i] = (double)ts_sum[i] / (double)itr_cnt;
+  }
+}
+
+// Convert count of items processed in `ts` nanoseconds to readable throughput
+// string i.e. in terms of items processed per second
+std::string
+to_readable_throughput(const size_t cnt, double ts)
+{
+  const double ps = (double)cnt / (ts * 1e-9);
+
+  return ps >= 1e9 ? std::to_string(ps * 1e-9) + " G/s"
+                   : ps >= 1e6 ? std::to_string(ps * 1e-6) + " M/s"
+                               : ps >= 1e3 ? std::to_string(ps * 1e-3) + " K/s"
+                                           : std::to_string(ps) + " /s";
+}
+
 // Convert nanosecond granularity execution time to readable string i.e. in
 // terms of seconds/ milliseconds/ microseconds/ nanoseconds
 std::string
@@ -0,0 +1,180 @@
+#pragma once
+#include "merklize.hpp"
+#include <cstring>
+#include <unordered_map>
+
+namespace merklize {
+
+// Persistent merklization context, which owns pools of device USM allocations
+// & pinned host ( USM host ) staging allocations, reused across calls, so that
+// allocation cost drops out of steady-state path
+//
+// Allocations are bucketed in power of 2 size classes, so a released buffer
+// can serve any later request of same size class. Pooled allocations are only
+// freed when context is destroyed.
+//
+// Note, context is not thread-safe & it must not outlive its queue
+class context
+{
+public:
+  explicit context(sycl::queue& q)
+    : q(q)
+  {}
+
+  context(const context&) = delete;
+  context& operator=(const context&) = delete;
+
+  ~context()
+  {
+    for (auto& [ptr, _] : owner) {
+      sycl::free(ptr, q);
+    }
+  }
+
+  // Returns device allocation of at least `size` -bytes, from pool, allocating
+  // only when there's no free one of same size class
+  uint32_t* acquire_device(const size_t size)
+  {
+    return acquire(size, sycl::usm::alloc::device);
+  }
+
+  // Returns pinned host allocation of at least `size` -bytes, which can be
+  // used for staging data transferred to/ from device, from pool, allocating
+  // only when there's no free one of same size class
+  uint32_t* acquire_host(const size_t size)
+  {
+    return acquire(size, sycl::usm::alloc::host);
+  }
+
+  // Returns allocation, acquired from this context, back to its pool
+  void release(uint32_t* const ptr)
+  {
+    auto it = owner.find(ptr);
+    assert(it != owner.end()); // ensure it's acquired from this context
+
+    pool[it->second].push_back(ptr);
+  }
+
+  // Number of allocations made so far, which is expected to stop growing,
+  // once steady-state is reached
+  size_t alloc_cnt() const { return owner.size(); }
+
+  // Computes all intermediate nodes of binary merkle tree with `leaf_cnt`
+  // leaves, using N subtrees ( see `merklize::merklize` ), where leaves are
+  // transferred from `leaves` to pooled device buffer & intermediates are
+  // transferred back to `intermediates`, both living in host memory
+  //
+  // Transfers always use pinned memory. When `leaves` ( or `intermediates` )
+  // isn't a USM host allocation ( e.g. it's `std::malloc` -ed ), it's staged
+  // through pooled pinned buffer, acquired using `acquire_host`, at cost of a
+  // host side copy, which can be avoided by passing buffers acquired using
+  // `acquire_host` itself.
+  //
+  // Last parameter of this function will return execution time of three
+  // operations, in following order
+  //
+  // - host -> device data tx time
+  // - kernel exec time
+  // - device -> host data tx time
+  //
+  // Host side copies to/ from staging buffers aren't part of those.
+  //
+  // Note, queue needs to have profiling enabled
+  template<size_t N, size_t TILE_LOG = 0>
+  void merklize(const size_t leaf_cnt,
+                const uint32_t* const leaves,
+                uint32_t* const intermediates,
+                sycl::cl_ulong* const ts)
+  {
+    const size_t size = leaf_cnt << 5;
+
+    const bool stage_i = !is_pinned(leaves);
+    const bool stage_o = !is_pinned(intermediates);
+
+    uint32_t* i_d = acquire_device(size);
+    uint32_t* o_d = acquire_device(size);
+    uint32_t* i_h = stage_i ? acquire_host(size) : nullptr;
+    uint32_t* o_h = stage_o ? acquire_host(size) : intermediates;
+
+    if (stage_i) {
+      std::memcpy(i_h, leaves, size);
+    }
+
+    std::vector<sycl::event> evts;
+
+    sycl::event evt0 = q.memcpy(i_d, stage_i ? i_h : leaves, size);
+    sycl::event evt = merklize_async<N, TILE_LOG>(
+      q, leaf_cnt, i_d, size, o_d, size, { evt0 }, &evts);
+    sycl::event evt1 = q.memcpy(o_h, o_d, size, evt);
+    evt1.wait();
+
+    if (stage_o) {
+      std::memcpy(intermediates, o_h, size);
+      release(o_h);
+    }
+    if (stage_i) {
+      release(i_h);
+    }
+
+    release(i_d);
+    release(o_d);
+
+    ts[0] = time_event(evt0);
+    ts[1] = exec_time<N>(evts);
+    ts[2] = time_event(evt1);
+  }
+
+private:
+  // Whether `ptr` is USM host allocation, which can be transferred to/ from
+  // device without staging
+  bool is_pinned(const void* const ptr) const
+  {
+    return sycl::get_pointer_type(ptr, q.get_context()) ==
+           sycl::usm::alloc::host;
+  }
+
+  using size_class = std::pair<size_t, sycl::usm::alloc>;
+
+  struct size_class_hash
+  {
+    size_t operator()(const size_class& c) const
+    {
+      return c.first ^ static_cast<size_t>(c.second);
+    }
+  };
+
+  uint32_t* acquire(const size_t size, const sycl::usm::alloc kind)
+  {
+    size_t cls = 32;
+    while (cls < size) {
+      cls <<= 1;
+    }
+
+    std::vector<uint32_t*>& free_list = pool[{ cls, kind }];
+
+    if (!free_list.empty()) {
+      uint32_t* ptr = free_list.back();
+      free_list.pop_back();
+
+      return ptr;
+    }
+
+    uint32_t* ptr =
+      static_cast<uint32_t*>(kind == sycl::usm::alloc::device
+                               ? sycl::malloc_device(cls, q)
+                               : sycl::malloc_host(cls, q));
+    owner[ptr] = { cls, kind };
+
+    return ptr;
+  }
+
+  sycl::queue& q;
+
+  // free allocations of each size class
+  std::unordered_map<size_class, std::vector<uint32_t*>, size_class_hash> pool;
+
+  // size class of each allocation made by this context
+  std::unordered_map<uint32_t*, size_class> owner;
+};
+
+}
@@ -0,0 +1,264 @@
+#pragma once
+#include <CL/sycl.hpp>
+#include <coroutine>
+#include <exception>
+#include <optional>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+// C++20 coroutine front-end for asynchronous routines returning SYCL events,
+// such as `merklize::merklize_async` and `sha256::hash_batch`, so that host
+// thread isn't blocked while device is computing
+//
+// Jobs are written as coroutines returning `coro::task`, which suspend on
+// `co_await ex.wait(evt)` ( or `co_await ex.submit<Family>(...)` ), while a
+// single host thread drives all of them by calling `ex.run()`, which resumes
+// each suspended coroutine once event it's waiting on completes.
+namespace coro {
+
+template<typename T = void>
+class task;
+
+// Checks whether command, whose submission resulted into supplied event, has
+// completed, without blocking
+static inline bool
+is_complete(const sycl::event& evt)
+{
+  return evt.get_info<sycl::info::event::command_execution_status>() ==
+         sycl::info::event_command_status::complete;
+}
+
+// Address of this variable identifies family of commands sharing same kernels,
+// see `executor::submit`
+template<typename Family>
+inline constexpr char family_key = 0;
+
+// Part of coroutine promise, common to all `task` types
+//
+// Coroutine is started lazily i.e. only when it's awaited or spawned on
+// executor, while at completion, control is transferred to awaiting coroutine
+// ( if any ), without growing host stack
+struct promise_base
+{
+  std::coroutine_handle<> continuation = std::noop_coroutine();
+  std::exception_ptr error;
+
+  struct final_awaiter
+  {
+    bool await_ready() noexcept { return false; }
+
+    template<typename P>
+    std::coroutine_handle<> await_suspend(std::coroutine_handle<P> h) noexcept
+    {
+      return h.promise().continuation;
+    }
+
+    void await_resume() noexcept {}
+  };
+
+  std::suspend_always initial_suspend() noexcept { return {}; }
+  final_awaiter final_suspend() noexcept { return {}; }
+  void unhandled_exception() { error = std::current_exception(); }
+
+  void rethrow()
+  {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+};
+
+// Promise part, which keeps value returned by coroutine
+template<typename T>
+struct promise_result : promise_base
+{
+  std::optional<T> value;
+
+  void return_value(T v) { value.emplace(std::move(v)); }
+
+  T result()
+  {
+    rethrow();
+    return std::move(*value);
+  }
+};
+
+template<>
+struct promise_result<void> : promise_base
+{
+  void return_void() {}
+  void result() { rethrow(); }
+};
+
+// Coroutine producing value of type T, which can be awaited from another
+// coroutine, or spawned on executor, see `executor::spawn`
+//
+// Task owns its coroutine frame, which is destroyed along with task, so task
+// must outlive its execution
+template<typename T>
+class task
+{
+public:
+  struct promise_type : promise_result<T>
+  {
+    task get_return_object()
+    {
+      return task{ std::coroutine_handle<promise_type>::from_promise(*this) };
+    }
+  };
+
+  task(task&& t) noexcept
+    : h(std::exchange(t.h, nullptr))
+  {}
+
+  task(const task&) = delete;
+  task& operator=(const task&) = delete;
+
+  ~task()
+  {
+    if (h) {
+      h.destroy();
+    }
+  }
+
+  // Whether coroutine has run to completion
+  bool done() const { return h.done(); }
+
+  // Value returned by completed coroutine, rethrowing exception, if coroutine
+  // exited with one
+  T get() { return h.promise().result(); }
+
+  // Awaiting task starts it, while awaiting coroutine is resumed once task
+  // completes
+  bool await_ready() const noexcept { return false; }
+
+  std::coroutine_handle<> await_suspend(std::coroutine_handle<> c) noexcept
+  {
+    h.promise().continuation = c;
+    return h;
+  }
+
+  T await_resume() { return h.promise().result(); }
+
+private:
+  friend class executor;
+
+  explicit task(std::coroutine_handle<promise_type> h)
+    : h(h)
+  {}
+
+  std::coroutine_handle<promise_type> h;
+};
+
+// Single threaded executor, which resumes coroutines suspended on SYCL events,
+// once those events complete
+//
+// Invocations of routines sharing same kernels ( and pipes ), such as all
+// `merklize::merklize_async<N>` invocations with same N, or all
+// `sha256::hash_batch<msg_len>` invocations with same message length, must not
+// overlap on device, so concurrent jobs must enqueue them using `submit`,
+// which chains each of them after previous one of same family. Commands
+// enqueued directly & awaited using `wait` aren't ordered across jobs.
+//
+// Note, executor is not thread-safe, all tasks are expected to be spawned &
+// driven from same host thread, which calls `run`
+class executor
+{
+public:
+  // Awaitable, suspending coroutine until command, whose submission resulted
+  // into `evt`, completes
+  struct event_awaiter
+  {
+    executor& ex;
+    sycl::event evt;
+
+    bool await_ready() const { return is_complete(evt); }
+
+    void await_suspend(std::coroutine_handle<> h)
+    {
+      ex.pending.emplace_back(evt, h);
+    }
+
+    void await_resume() const {}
+  };
+
+  // To be awaited from coroutine, i.e. `co_await ex.wait(evt)`
+  event_awaiter wait(sycl::event evt) { return event_awaiter{ *this, evt }; }
+
+  // Enqueues command(s) sharing kernels of `Family` ( any type identifying
+  // them, e.g. name of orchestrator kernel ), by invoking `enqueue(deps)`,
+  // which must return event of last command it enqueues, while `deps` holds
+  // event of previous command of same family, if any. To be awaited from
+  // coroutine, i.e.
+  //
+  // co_await ex.submit<Family>([&](const std::vector<sycl::event>& deps) {
+  //   return merklize::merklize_async<N>(q, ..., deps);
+  // });
+  template<typename Family, typename Enqueue>
+  event_awaiter submit(Enqueue enqueue)
+  {
+    const void* const key = &family_key<Family>;
+
+    std::vector<sycl::event> deps;
+    if (auto it = last.find(key); it != last.end()) {
+      deps.push_back(it->second);
+    }
+
+    sycl::event evt = enqueue(deps);
+    last.insert_or_assign(key, evt);
+
+    return wait(evt);
+  }
+
+  // Starts task, which runs until it first suspends on some event, while rest
+  // of it runs as part of `run`
+  template<typename T>
+  void spawn(task<T>& t)
+  {
+    t.h.resume();
+  }
+
+  // Resumes each coroutine suspended on some event, once that event
+  // completes, until no coroutine is left suspended, while when none of them
+  // can be resumed, host thread blocks on oldest pending event, instead of
+  // spinning
+  //
+  // Note, as SYCL can't wait on whichever of many events completes first, a
+  // coroutine whose event completes while host thread is blocked on an older
+  // one, is resumed only after that older command also completes
+  void run()
+  {
+    while (!pending.empty()) {
+      bool progress = false;
+
+      for (size_t i = 0; i < pending.size();) {
+        if (!is_complete(pending[i].first)) {
+          i++;
+          continue;
+        }
+
+        std::coroutine_handle<> h = pending[i].second;
+
+        // resumed coroutine may suspend again, appending to `pending`
+        pending.erase(pending.begin() + i);
+        h.resume();
+
+        progress = true;
+      }
+
+      if (!progress) {
+        pending.front().first.wait_and_throw();
+      }
+    }
+  }
+
+private:
+  // suspended coroutines, in order of suspension
+  std::vector<std::pair<sycl::event, std::coroutine_handle<>>> pending;
+
+  // last command enqueued by `submit`, of each family
+  std::unordered_map<const void*, sycl::event> last;
+};
+
+}
@@ -0,0 +1,216 @@
+#pragma once
+#include "sha256.hpp"
+#include <algorithm>
+#include <vector>
+
+namespace engine {
+
+// Capacity of each SYCL pipe connecting orchestrator & hash engine kernels,
+// which is also the number of messages an orchestrator keeps in flight, so
+// that hash engine pipeline never starves while orchestrator is busy writing
+// digests back to global memory
+//
+// Unrolled engine accepts new message every cycle, but it takes hundreds of
+// cycles to produce digest of it, so it needs a lot more messages in flight
+constexpr size_t PIPE_DEPTH =
+  sha256::VARIANT == sha256::variant::unrolled ? 512 : 64;
+
+// 512 -bit input message of SHA256 2-to-1 hash, which is two 256 -bit
+// digests concatenated together, sent from orchestrator to hash engine
+struct message_t
+{
+  uint32_t words[16];
+};
+
+// 256 -bit SHA256 digest, sent back from hash engine to orchestrator
+struct digest_t
+{
+  uint32_t words[8];
+};
+
+// Each orchestrator kernel ( identified by `Tag` ) gets its own hash engine
+// kernel and a pair of pipes connecting them, so that engines can be
+// replicated by just instantiating these templates with another tag
+template<typename Tag>
+class kernelSHA256Hash;
+
+template<typename Tag>
+class pipeMessageId;
+
+template<typename Tag>
+class pipeDigestId;
+
+template<typename Tag>
+using message_pipe =
+  sycl::ext::intel::pipe<pipeMessageId<Tag>, message_t, PIPE_DEPTH>;
+
+template<typename Tag>
+using digest_pipe =
+  sycl::ext::intel::pipe<pipeDigestId<Tag>, digest_t, PIPE_DEPTH>;
+
+// Reads 64 contiguous bytes ( = 16 words ) from global memory, starting at
+// word offset `off`, as input message of SHA256 2-to-1 hash
+//
+// When hash engine works with shorter messages, only first `words` -many words
+// are read, leaving rest of message undefined
+template<size_t words = 16, typename Ptr>
+static inline message_t
+load_message(Ptr ptr, const size_t off) requires(words <= 16)
+{
+  message_t msg;
+
+#pragma unroll // upto 512 -bit burst coalesced global memory read
+  for (size_t j = 0; j < words; j++) {
+    msg.words[j] = ptr[off + j];
+  }
+
+  return msg;
+}
+
+// Reads two 32 -bytes digests ( = 8 words each ), starting at word offsets
+// `l_off` & `r_off` of global memory, concatenating them into input message of
+// SHA256 2-to-1 hash, so that siblings need not be placed next to each other
+template<typename Ptr>
+static inline message_t
+load_pair(Ptr ptr, const size_t l_off, const size_t r_off)
+{
+  message_t msg;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read
+  for (size_t j = 0; j < 8; j++) {
+    msg.words[j] = ptr[l_off + j];
+  }
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read
+  for (size_t j = 0; j < 8; j++) {
+    msg.words[8 + j] = ptr[r_off + j];
+  }
+
+  return msg;
+}
+
+// Writes 32 -bytes digest ( = 8 words ) to global memory, starting at word
+// offset `off`
+template<typename Ptr>
+static inline void
+store_digest(Ptr ptr, const size_t off, const digest_t& dig)
+{
+#pragma unroll 8 // 256 -bit burst coalesced global memory write
+  for (size_t j = 0; j < 8; j++) {
+    ptr[off + j] = dig.words[j];
+  }
+}
+
+// Launches SHA256 hash engine kernel, paired with orchestrator kernel
+// identified by `Tag`, which consumes `msg_cnt` -many messages of `msg_len`
+// bytes from message pipe & for each of them produces 256 -bit digest into
+// digest pipe
+//
+// 64 -bytes messages are hashed using `sha256::hash_2_to_1`, so constant
+// padding block is mixed in using precomputed message schedule, while shorter
+// word aligned messages ( such as 32 -bytes digests ) are padded into single
+// message block & hashed with just one compression, see
+// `sha256::hash_single_block`
+//
+// When `sha256d` is set, 32 -bytes digest is hashed once again, using single
+// message block compression, chained in same pipeline, computing
+// SHA256(SHA256(msg)) e.g. for Bitcoin style merkle trees
+//
+// Engine doesn't touch global memory at all, so its loop can be pipelined
+// independent of orchestrator's memory access pattern. Execution starts after
+// all `deps` complete.
+template<typename Tag, size_t msg_len = 64, bool sha256d = false>
+sycl::event
+launch(sycl::queue& q,
+       const size_t msg_cnt,
+       const std::vector<sycl::event>& deps = {})
+  requires(msg_len == 64 || ((msg_len & 3) == 0 && msg_len <= 52))
+{
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<kernelSHA256Hash<Tag>>([=]() {
+      auto hash_one = [&]() {
+        [[intel::fpga_register]] uint32_t hash_state[8];
+        [[intel::fpga_register]] uint32_t
+          msg_schld[sha256::schedule_words(sha256::VARIANT)];
+
+        message_t msg = message_pipe<Tag>::read();
+
+        if constexpr (msg_len == 64) {
+          sha256::hash_2_to_1<sha256::VARIANT>(
+            hash_state, msg_schld, msg.words);
+        } else {
+          [[intel::fpga_register]] uint32_t block[16];
+
+          sha256::pad_short_message<msg_len>(msg.words, block);
+          sha256::hash_single_block<sha256::VARIANT>(
+            hash_state, msg_schld, block);
+        }
+
+        if constexpr (sha256d) {
+          [[intel::fpga_register]] uint32_t block[16];
+
+          sha256::pad_short_message<32>(hash_state, block);
+          sha256::hash_single_block<sha256::VARIANT>(
+            hash_state, msg_schld, block);
+        }
+
+        digest_t dig;
+
+#pragma unroll 8
+        for (size_t j = 0; j < 8; j++) {
+          dig.words[j] = hash_state[j];
+        }
+
+        digest_pipe<Tag>::write(dig);
+      };
+
+      // there's no loop carried dependency, so with unrolled engine, a new
+      // message enters the pipeline every cycle
+      if constexpr (sha256::VARIANT == sha256::variant::unrolled) {
+        [[intel::initiation_interval(1)]] for (size_t i = 0; i < msg_cnt;
+                                               i++)
+        {
+          hash_one();
+        }
+      } else {
+        for (size_t i = 0; i < msg_cnt; i++) {
+          hash_one();
+        }
+      }
+    });
+  });
+}
+
+// To be invoked from orchestrator kernel identified by `Tag`, which streams
+// `msg_cnt` -many messages through its hash engine, where i-th message is
+// produced by `load(i)` & i-th digest is consumed by `store(i, digest)`
+//
+// Up to `PIPE_DEPTH` messages are kept in flight, so reading of next
+// messages from global memory overlaps with hashing of previous ones & with
+// writing back of their digests. Storing lags loading by
+// min(msg_cnt, PIPE_DEPTH) messages, so that short streams ( e.g. upper levels
+// of a tile ) don't pay for whole pipe depth, while pipe always has room for
+// messages in flight. Note, `load` must not read anything written by `store`
+// during same invocation, because i-th digest is stored only after
+// (i + min(msg_cnt, PIPE_DEPTH)) -th message is loaded
+template<typename Tag, typename Load, typename Store>
+static inline void
+stream(const size_t msg_cnt, Load load, Store store)
+{
+  const size_t lag = std::min(msg_cnt, PIPE_DEPTH);
+
+  [[intel::ivdep]] for (size_t i = 0; i < msg_cnt + lag; i++)
+  {
+    if (i < msg_cnt) {
+      message_pipe<Tag>::write(load(i));
+    }
+
+    if (i >= lag) {
+      store(i - lag, digest_pipe<Tag>::read());
+    }
+  }
+}
+
+}
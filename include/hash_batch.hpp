@@ -0,0 +1,68 @@
+#pragma once
+#include "engine.hpp"
+#include <vector>
+
+namespace sha256 {
+
+// Kernel predeclared to avoid name mangling in optimization report
+//
+// Note, its hash engine kernel is named after it, see
+// `engine::kernelSHA256Hash`
+template<size_t msg_len>
+class kernelSHA256BatchOrchestrator;
+
+// Computes SHA256 digests of `msg_cnt` -many independent `msg_len` -bytes
+// messages, where i-th message is (msg_len >> 2) words, starting at word offset
+// i * (msg_len >> 2) of `in` & its 32 -bytes digest is written as 8 words,
+// starting at word offset (i << 3) of `out`
+//
+// Message length must be either 64 -bytes ( e.g. two concatenated digests ),
+// or word aligned and short enough ( <= 52 -bytes, e.g. 32 -bytes leaf ) to be
+// padded into single message block, in which case each message is hashed
+// with just one compression
+//
+// Messages are streamed through SHA256 hash engine kernel over SYCL pipes,
+// while orchestrator kernel only does 512 -bit burst coalesced loads and 256
+// -bit burst coalesced stores, keeping up to `engine::PIPE_DEPTH` messages in
+// flight, see `engine::stream`
+//
+// Both `in` and `out` need to be USM device allocations. Execution starts
+// after all `deps` complete, while returned event can be used for chaining
+// more commands, without blocking caller
+//
+// Note, all invocations with same `msg_len` share same kernels ( and pipes ),
+// so when enqueuing multiple batches back to back, event returned by previous
+// invocation must be passed in `deps` of next one
+template<size_t msg_len = 64>
+sycl::event
+hash_batch(sycl::queue& q,
+           const uint32_t* const __restrict in,
+           uint32_t* const __restrict out,
+           const size_t msg_cnt,
+           const std::vector<sycl::event>& deps = {})
+{
+  using Tag = kernelSHA256BatchOrchestrator<msg_len>;
+  constexpr size_t words = msg_len >> 2;
+
+  engine::launch<Tag, msg_len>(q, msg_cnt, deps);
+
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<Tag>([=]() {
+      sycl::device_ptr<const uint32_t> in_ptr{ in };
+      sycl::device_ptr<uint32_t> out_ptr{ out };
+
+      engine::stream<Tag>(
+        msg_cnt,
+        [&](const size_t i) {
+          return engine::load_message<words>(in_ptr, i * words);
+        },
+        [&](const size_t i, const engine::digest_t& dig) {
+          engine::store_digest(out_ptr, i << 3, dig);
+        });
+    });
+  });
+}
+
+}
@@ -1,17 +1,22 @@
 #pragma once
-#include "sha256.hpp"
+#include "engine.hpp"
 #include "utils.hpp"
 #include <cassert>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 namespace merklize {
 
-#define SHA256KernelDecl(idx) class kernelSHA256Hash##idx
-#define MerklizeKernelDecl(idx) class kernelMerklizationOrchestrator##idx
-
 // Kernels predeclared to avoid name mangling in optimization report
-MerklizeKernelDecl(0);
-MerklizeKernelDecl(1);
-MerklizeKernelDecl(2);
+//
+// Note, hash engine kernels are named after the orchestrator kernel they
+// are paired with, see `engine::kernelSHA256Hash`
+template<size_t N, size_t idx, size_t tile_log = 0, bool zero_copy = false>
+class kernelMerklizationOrchestrator;
+
+template<size_t N>
+class kernelMerklizationReduction;
 
 // Computes binary logarithm of number `n`,
 // where n = 2 ^ i | i = {1, 2, 3 ...}
@@ -28,189 +33,304 @@ bin_log(size_t n)
   return cnt;
 }
 
-// Computes all intermediate nodes of Binary Merkle Tree using SHA256
-// 2-to-1 hash function, where leaf node count is power of 2 value
+// Launches orchestrator kernel ( identified by `Tag` ) along with its hash
+// engine, which computes intermediate nodes of binary merkle tree, level by
+// level, starting from level having `w_hi` nodes upto level having `w_lo`
+// nodes, while each level is split into `slice_cnt` equal width slices & this
+// orchestrator only computes `slice_idx` -th slice of each level
 //
-// In this routine, kernel pairs ( orchestrator <-> sha256hash ) will be
-// communicating over SYCL pipes, where orchestrator kernel which is
-// responsible for driving multiple phases ( dependent on previously
-// completed one ) of computation of intermediates of binary merkle tree,
-// sends padded input message words ( = 32 ) over blocking SYCL pipe and
-// waits for completion of SHA256 computation on compute kernel, which
-// finally sends back 32 -bytes digest to orchestrator for placing it in
-// proper position in output memory allocation (on global memory), which
-// will again be used in next level of intermediate node computation, if
-// not in root level of tree
+// Intermediate nodes are kept in level order i.e. k-th node ( 1 based
+// indexing, root being 1st node ) lives at 32 -bytes wide slot starting at
+// word offset (k << 3) of `intermediates`, while its children live at k-th
+// 64 -bytes wide slot. Children of level having (leaf_cnt >> 1) nodes are
+// read from `leaves` instead.
 //
-// Ensure that SYCL queue has profiling enabled, as at successful
-// completion of this routine it returns time spent in computing all
-// intermediate nodes of binary merkle tree
-sycl::cl_ulong
-merklize(sycl::queue& q,
-         const size_t leaf_cnt,
-         uint32_t* const __restrict leaves,
-         const size_t i_size,
-         uint32_t* const __restrict intermediates,
-         const size_t o_size)
+// When `tile_log` ( = k ) is non-zero, leaves of this slice are consumed in
+// tiles of 2^k leaves, while all k levels of a tile's subtree are computed from
+// on-chip memory, so that only leaves and levels above tile roots are read
+// from global memory. Each computed node is still written back to
+// `intermediates`. This requires `w_hi` to be (leaf_cnt >> 1) & each slice to
+// have at least 2^k leaves.
+//
+// When `slice_leaves` is set, `leaves` holds only (leaf_cnt / slice_cnt)
+// leaves of this slice, instead of all leaves of tree, so that leaves can be
+// brought to device memory, slice by slice.
+//
+// When `host_leaves` is set, `leaves` is a host ( or shared ) USM allocation,
+// which is read by orchestrator directly over PCIe, instead of from device
+// memory.
+//
+// Hash engine is launched with same dependencies as orchestrator, so that
+// same pair of kernels can be enqueued back to back.
+//
+// Note, `w_hi`, `w_lo` and `slice_cnt` all need to be power of 2, such that
+// slice_cnt <= w_lo <= w_hi <= (leaf_cnt >> 1)
+template<typename Tag,
+         size_t tile_log = 0,
+         bool slice_leaves = false,
+         bool host_leaves = false>
+sycl::event
+orchestrate(sycl::queue& q,
+            const size_t leaf_cnt,
+            uint32_t* const __restrict leaves,
+            uint32_t* const __restrict intermediates,
+            const size_t w_hi,
+            const size_t w_lo,
+            const size_t slice_cnt,
+            const size_t slice_idx,
+            const std::vector<sycl::event>& deps = {})
 {
-  assert(i_size == o_size);                 // ensure enough memory allocated
-  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  const size_t log_slice_cnt = bin_log(slice_cnt);
 
-  sycl::event evt0 = q.single_task<kernelMerklizationOrchestrator0>([=]() {
-    sycl::device_ptr<uint32_t> leaves_ptr{ leaves };
-    sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
-
-    [[intel::fpga_register]] uint32_t msg[16];
-    [[intel::fpga_register]] uint32_t padded[32];
-    [[intel::fpga_register]] uint32_t hash_state[8];
-    [[intel::fpga_register]] uint32_t msg_schld[64];
-
-    const size_t i_offset = 0;
-    const size_t o_offset = (leaf_cnt >> 1) << 3;
-    const size_t itr_cnt = leaf_cnt >> 2;
-
-    [[intel::ivdep]] for (size_t i = 0; i < itr_cnt; i++)
-    {
-      const size_t i_offset_0 = i_offset + (i << 4);
-      const size_t o_offset_0 = o_offset + (i << 3);
-
-#pragma unroll 16 // 512 -bit burst coalesced global memory read
-      for (size_t j = 0; j < 16; j++) {
-        msg[j] = leaves_ptr[i_offset_0 + j];
-      }
+  if constexpr (tile_log > 0) {
+    assert(w_hi == (leaf_cnt >> 1));
+    assert((w_hi >> log_slice_cnt) >= (1ul << (tile_log - 1)));
+  }
 
-      sha256::pad_input_message(msg, padded);
-      sha256::hash(hash_state, msg_schld, padded);
+  // total 2-to-1 hashes computed by this orchestrator
+  const size_t msg_cnt = ((w_hi << 1) - w_lo) >> log_slice_cnt;
 
-#pragma unroll 8 // 256 -bit burst coalesced global memory write
-      for (size_t j = 0; j < 8; j++) {
-        intermediates_ptr[o_offset_0 + j] = hash_state[j];
-      }
-    }
+  // word offset of first leaf of this slice, in `leaves`
+  const size_t l_base =
+    slice_leaves ? 0 : (slice_idx * (leaf_cnt >> log_slice_cnt)) << 3;
 
-    // these many levels of intermediate nodes ( excluding root of tree
-    // ) remaining to be computed, where (i+1)-th level is dependent on
-    // i-th level, while indexing is done bottom up
-    const size_t rounds = bin_log(leaf_cnt >> 2);
+  engine::launch<Tag>(q, msg_cnt, deps);
 
-    for (size_t r = 0; r < rounds; r++) {
-      const size_t i_offset = (leaf_cnt << 2) >> r;
-      const size_t o_offset = i_offset >> 1;
-      const size_t itr_cnt = leaf_cnt >> (r + 3);
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
 
-      [[intel::ivdep]] for (size_t i = 0; i < itr_cnt; i++)
-      {
-        const size_t i_offset_0 = i_offset + (i << 4);
-        const size_t o_offset_0 = o_offset + (i << 3);
+    h.single_task<Tag>([=]() {
+      std::conditional_t<host_leaves,
+                         sycl::ext::intel::host_ptr<uint32_t>,
+                         sycl::device_ptr<uint32_t>>
+        leaves_ptr{ leaves };
+      sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
 
-#pragma unroll 16 // 512 -bit burst coalesced global memory read
-        for (size_t j = 0; j < 16; j++) {
-          msg[j] = intermediates_ptr[i_offset_0 + j];
+      size_t w_top = w_hi;
+
+      if constexpr (tile_log > 0) {
+        // tile's subtree, in level order, where m-th node ( 1 based indexing )
+        // lives at word offset (m << 3), same as `intermediates`
+        [[intel::fpga_memory("BLOCK_RAM")]] uint32_t tile[8ul << tile_log];
+
+        const size_t tile_cnt = (w_hi >> log_slice_cnt) >> (tile_log - 1);
+
+        for (size_t t = 0; t < tile_cnt; t++) {
+          const size_t t_idx = slice_idx * tile_cnt + t;
+
+          // (i+1)-th level of tile is dependent on i-th level of tile, while
+          // indexing is done bottom up
+          for (size_t j = 1; j <= tile_log; j++) {
+            const size_t itr_cnt = 1ul << (tile_log - j);
+            const size_t o_node = (w_hi >> (j - 1)) + t_idx * itr_cnt;
+
+            auto store = [&](const size_t i, const engine::digest_t& dig) {
+              engine::store_digest(tile, (itr_cnt + i) << 3, dig);
+              engine::store_digest(intermediates_ptr, (o_node + i) << 3, dig);
+            };
+
+            if (j == 1) {
+              const size_t i_offset = l_base + ((t << tile_log) << 3);
+
+              engine::stream<Tag>(
+                itr_cnt,
+                [&](const size_t i) {
+                  return engine::load_message(leaves_ptr, i_offset + (i << 4));
+                },
+                store);
+            } else {
+              engine::stream<Tag>(
+                itr_cnt,
+                [&](const size_t i) {
+                  return engine::load_message(tile, (itr_cnt + i) << 4);
+                },
+                store);
+            }
+          }
         }
 
-        sha256::pad_input_message(msg, padded);
-        sha256::hash(hash_state, msg_schld, padded);
+        w_top = w_hi >> tile_log;
+      }
 
-#pragma unroll 8 // 256 -bit burst coalesced global memory write
-        for (size_t j = 0; j < 8; j++) {
-          intermediates_ptr[o_offset_0 + j] = hash_state[j];
+      // (i+1)-th level is dependent on i-th level, while indexing is done
+      // bottom up
+      for (size_t w = w_top; w >= w_lo; w >>= 1) {
+        const size_t itr_cnt = w >> log_slice_cnt;
+        const size_t o_node = w + slice_idx * itr_cnt;
+
+        if (w == (leaf_cnt >> 1)) {
+          engine::stream<Tag>(
+            itr_cnt,
+            [&](const size_t i) {
+              return engine::load_message(leaves_ptr, l_base + (i << 4));
+            },
+            [&](const size_t i, const engine::digest_t& dig) {
+              engine::store_digest(intermediates_ptr, (o_node + i) << 3, dig);
+            });
+        } else {
+          engine::stream<Tag>(
+            itr_cnt,
+            [&](const size_t i) {
+              return engine::load_message(intermediates_ptr,
+                                          (o_node + i) << 4);
+            },
+            [&](const size_t i, const engine::digest_t& dig) {
+              engine::store_digest(intermediates_ptr, (o_node + i) << 3, dig);
+            });
         }
       }
-    }
+    });
   });
+}
 
-  sycl::event evt1 = q.single_task<kernelMerklizationOrchestrator1>([=]() {
-    sycl::device_ptr<uint32_t> leaves_ptr{ leaves };
-    sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
-
-    [[intel::fpga_register]] uint32_t msg[16];
-    [[intel::fpga_register]] uint32_t padded[32];
-    [[intel::fpga_register]] uint32_t hash_state[8];
-    [[intel::fpga_register]] uint32_t msg_schld[64];
-
-    const size_t i_offset = (leaf_cnt >> 1) << 3;
-    const size_t o_offset = i_offset + (i_offset >> 1);
-    const size_t itr_cnt = leaf_cnt >> 2;
-
-    [[intel::ivdep]] for (size_t i = 0; i < itr_cnt; i++)
-    {
-      const size_t i_offset_0 = i_offset + (i << 4);
-      const size_t o_offset_0 = o_offset + (i << 3);
-
-#pragma unroll 16 // 512 -bit burst coalesced global memory read
-      for (size_t j = 0; j < 16; j++) {
-        msg[j] = leaves_ptr[i_offset_0 + j];
-      }
-
-      sha256::pad_input_message(msg, padded);
-      sha256::hash(hash_state, msg_schld, padded);
-
-#pragma unroll 8 // 256 -bit burst coalesced global memory write
-      for (size_t j = 0; j < 8; j++) {
-        intermediates_ptr[o_offset_0 + j] = hash_state[j];
-      }
-    }
-
-    // these many levels of intermediate nodes ( excluding root of tree
-    // ) remaining to be computed, where (i+1)-th level is dependent on
-    // i-th level, while indexing is done bottom up
-    const size_t rounds = bin_log(leaf_cnt >> 2);
-
-    for (size_t r = 0; r < rounds; r++) {
-      const size_t i_offset = ((leaf_cnt << 2) + (leaf_cnt << 1)) >> r;
-      const size_t o_offset = i_offset >> 1;
-      const size_t itr_cnt = leaf_cnt >> (r + 3);
+// Computes all intermediate nodes of Binary Merkle Tree using SHA256
+// 2-to-1 hash function, where leaf node count is power of 2 value
+//
+// Tree is split into N ( power of 2 ) independent subtrees, rooted at N
+// consecutive nodes of level having N nodes, each of them computed by its own
+// orchestrator kernel, all generated from same template body. Once all
+// subtrees are computed, top log2(N) levels of tree are finished by a single
+// reduction kernel. Note, N must be <= (leaf_cnt >> 1).
+//
+// In this routine, kernel pairs ( orchestrator <-> sha256hash ) will be
+// communicating over SYCL pipes, where orchestrator kernel which is
+// responsible for driving multiple phases ( dependent on previously
+// completed one ) of computation of intermediates of binary merkle tree,
+// sends input message words ( = 16 ) over blocking SYCL pipe to compute
+// kernel, which pads & hashes them, finally sending back 32 -bytes digest
+// to orchestrator for placing it in proper position in output memory
+// allocation (on global memory), which will again be used in next level of
+// intermediate node computation, if not in root level of tree
+//
+// Orchestrator doesn't wait for each digest before sending next message,
+// instead it keeps up to `engine::PIPE_DEPTH` messages in flight, so that
+// global memory access and SHA256 compression run as separate pipelines
+//
+// When TILE_LOG ( = k ) is non-zero, each subtree orchestrator computes lowest
+// k levels of its subtree tile by tile, in on-chip memory, reading only leaves
+// from global memory, so that global memory reads for those levels drop by
+// roughly k times. Note, then each subtree must have at least 2^k leaves.
+//
+// When ZERO_COPY is set, `leaves` must be a host ( `sycl::malloc_host` ) or
+// shared USM allocation, which subtree orchestrators read directly over PCIe,
+// so that leaves aren't staged in device memory at all, while intermediates
+// are still kept in device memory. Otherwise `leaves` must be accessible from
+// device memory, so any host memory needs to be transferred first ( which is
+// faster from pinned memory, than from pageable one ).
+//
+// Intermediates are computed asynchronously, starting after all `deps`
+// complete, while returned event completes when root is computed, so that
+// more commands ( e.g. transfer of intermediates back to host ) can be chained
+// after it, without blocking caller. When `evts` is non-null, events of all
+// kernels ( subtree orchestrators, followed by reduction kernel, if any ) are
+// appended to it, see `exec_time`.
+//
+// Note, all invocations with same N share same reduction kernel ( and its
+// pipes ), irrespective of TILE_LOG & ZERO_COPY, while subtree orchestrators
+// are shared by invocations with same template arguments, so when enqueuing
+// multiple trees with same N back to back, event returned by previous
+// invocation must be passed in `deps` of next one, while transfer of leaves of
+// next tree can still overlap with computation of previous one.
+template<size_t N, size_t TILE_LOG = 0, bool ZERO_COPY = false>
+sycl::event
+merklize_async(sycl::queue& q,
+               const size_t leaf_cnt,
+               uint32_t* const __restrict leaves,
+               const size_t i_size,
+               uint32_t* const __restrict intermediates,
+               const size_t o_size,
+               const std::vector<sycl::event>& deps = {},
+               std::vector<sycl::event>* const evts = nullptr)
+  requires((N > 0) && ((N & (N - 1)) == 0))
+{
+  assert(i_size == o_size);                 // ensure enough memory allocated
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  assert(leaf_cnt >= (N << 1));             // ensure each subtree has leaves
+  assert(leaf_cnt >= (N << TILE_LOG));      // ensure each subtree has tiles
+
+  if constexpr (ZERO_COPY) {
+    // ensure leaves can be read directly from host memory
+    [[maybe_unused]] const sycl::usm::alloc kind =
+      sycl::get_pointer_type(leaves, q.get_context());
+    assert(kind == sycl::usm::alloc::host || kind == sycl::usm::alloc::shared);
+  }
 
-      [[intel::ivdep]] for (size_t i = 0; i < itr_cnt; i++)
-      {
-        const size_t i_offset_0 = i_offset + (i << 4);
-        const size_t o_offset_0 = o_offset + (i << 3);
+  std::vector<sycl::event> subtree_evts(N);
+
+  [&]<size_t... idx>(std::index_sequence<idx...>)
+  {
+    ((subtree_evts[idx] =
+        orchestrate<kernelMerklizationOrchestrator<N, idx, TILE_LOG, ZERO_COPY>,
+                    TILE_LOG,
+                    false,
+                    ZERO_COPY>(
+          q, leaf_cnt, leaves, intermediates, leaf_cnt >> 1, N, N, idx, deps)),
+     ...);
+  }
+  (std::make_index_sequence<N>{});
 
-#pragma unroll 16 // 512 -bit burst coalesced global memory read
-        for (size_t j = 0; j < 16; j++) {
-          msg[j] = intermediates_ptr[i_offset_0 + j];
-        }
+  sycl::event evt = subtree_evts[0];
 
-        sha256::pad_input_message(msg, padded);
-        sha256::hash(hash_state, msg_schld, padded);
+  if constexpr (N > 1) {
+    // --- compute top log2(N) levels of merkle tree, including root ---
+    evt = orchestrate<kernelMerklizationReduction<N>>(
+      q, leaf_cnt, leaves, intermediates, N >> 1, 1, 1, 0, subtree_evts);
+  }
 
-#pragma unroll 8 // 256 -bit burst coalesced global memory write
-        for (size_t j = 0; j < 8; j++) {
-          intermediates_ptr[o_offset_0 + j] = hash_state[j];
-        }
-      }
+  if (evts != nullptr) {
+    evts->insert(evts->end(), subtree_evts.begin(), subtree_evts.end());
+    if constexpr (N > 1) {
+      evts->push_back(evt);
     }
-  });
+  }
 
-  // --- compute root of merkle tree ---
-  sycl::event evt2 = q.submit([&](sycl::handler& h) {
-    h.depends_on({ evt0, evt1 });
+  return evt;
+}
 
-    h.single_task<kernelMerklizationOrchestrator2>([=]() {
-      sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
+// Given events of all kernels, which `merklize_async<N>` has appended, in same
+// order, returns time spent in computing all intermediate nodes of binary
+// merkle tree i.e. slowest subtree's execution time, followed by execution time
+// of reduction kernel, if any
+//
+// Note, ensure that all those kernels have completed & SYCL queue has
+// profiling enabled
+template<size_t N>
+sycl::cl_ulong
+exec_time(const std::vector<sycl::event>& evts)
+{
+  assert(evts.size() == (N > 1 ? N + 1 : N));
 
-      [[intel::fpga_register]] uint32_t msg[16];
-      [[intel::fpga_register]] uint32_t padded[32];
-      [[intel::fpga_register]] uint32_t hash_state[8];
-      [[intel::fpga_register]] uint32_t msg_schld[64];
+  sycl::cl_ulong subtree_tm = 0;
+  for (size_t i = 0; i < N; i++) {
+    subtree_tm = std::max(subtree_tm, time_event(evts[i]));
+  }
 
-#pragma unroll 16 // 512 -bit burst coalesced global memory read
-      for (size_t j = 0; j < 16; j++) {
-        msg[j] = intermediates_ptr[16 + j];
-      }
+  const sycl::cl_ulong reduction_tm = N > 1 ? time_event(evts[N]) : 0;
 
-      sha256::pad_input_message(msg, padded);
-      sha256::hash(hash_state, msg_schld, padded);
+  return subtree_tm + reduction_tm;
+}
 
-#pragma unroll 8 // 256 -bit burst coalesced global memory write
-      for (size_t j = 0; j < 8; j++) {
-        intermediates_ptr[8 + j] = hash_state[j];
-      }
-    });
-  });
+// Blocking variant of `merklize_async`, which waits for completion of
+// computation of all intermediates
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent in computing all
+// intermediate nodes of binary merkle tree
+template<size_t N, size_t TILE_LOG = 0, bool ZERO_COPY = false>
+sycl::cl_ulong
+merklize(sycl::queue& q,
+         const size_t leaf_cnt,
+         uint32_t* const __restrict leaves,
+         const size_t i_size,
+         uint32_t* const __restrict intermediates,
+         const size_t o_size) requires((N > 0) && ((N & (N - 1)) == 0))
+{
+  std::vector<sycl::event> evts;
 
-  evt2.wait();
+  merklize_async<N, TILE_LOG, ZERO_COPY>(
+    q, leaf_cnt, leaves, i_size, intermediates, o_size, {}, &evts)
+    .wait();
 
-  return std::max(time_event(evt0), time_event(evt1)) + time_event(evt2);
+  return exec_time<N>(evts);
 }
 }
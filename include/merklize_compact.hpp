@@ -0,0 +1,280 @@
+#pragma once
+#include "engine.hpp"
+#include "utils.hpp"
+#include <algorithm>
+#include <cassert>
+#include <vector>
+
+namespace merklize {
+
+// Kernels predeclared to avoid name mangling in optimization report
+//
+// Note, their hash engine kernels are named after them, see
+// `engine::kernelSHA256Hash`
+class kernelRFC6962Orchestrator;
+class kernelSHA256dOrchestrator;
+
+// Compact level layout of binary merkle tree with arbitrary ( >= 1 ) leaf
+// count, where leaves are at level 0 & each level has half as many nodes as
+// level below it, rounded up, so that root is at level `level_cnt(leaf_cnt)`
+//
+// Levels above leaves are kept in `intermediates`, top down, starting from
+// root at slot 1 ( each slot is 32 -bytes wide ), while each level occupies
+// `level_width` contiguous slots, starting at `level_offset`. Slot 0 is kept
+// unused, so that when leaf count is power of 2, layout is same as the one
+// `merklize::merklize` produces.
+
+// Number of nodes at level `lvl` of tree with `leaf_cnt` leaves
+static inline size_t
+level_width(const size_t leaf_cnt, const size_t lvl)
+{
+  size_t w = leaf_cnt;
+  for (size_t i = 0; i < lvl; i++) {
+    w = (w + 1) >> 1;
+  }
+
+  return w;
+}
+
+// Number of levels above leaves in tree with `leaf_cnt` leaves
+static inline size_t
+level_cnt(const size_t leaf_cnt)
+{
+  size_t w = leaf_cnt;
+  size_t cnt = 0;
+
+  while (w > 1) {
+    w = (w + 1) >> 1;
+    cnt++;
+  }
+
+  return cnt;
+}
+
+// Index of first slot of level `lvl` ( >= 1 ) in `intermediates`
+static inline size_t
+level_offset(const size_t leaf_cnt, const size_t lvl)
+{
+  const size_t top = level_cnt(leaf_cnt);
+
+  size_t off = 1;
+  for (size_t i = top; i > lvl; i--) {
+    off += level_width(leaf_cnt, i);
+  }
+
+  return off;
+}
+
+// Number of 32 -bytes slots `intermediates` must have, for keeping all levels
+// of tree with `leaf_cnt` leaves
+static inline size_t
+slot_cnt(const size_t leaf_cnt)
+{
+  return level_offset(leaf_cnt, 1) + level_width(leaf_cnt, 1);
+}
+
+// Computes all intermediate nodes of Binary Merkle Tree using SHA256 2-to-1
+// hash function, where leaf node count is arbitrary, following split rule of
+// RFC 6962 ( also used by CometBFT ) i.e. left subtree covers largest power of
+// 2 leaves, less than total leaf count, while right subtree covers the rest
+//
+// Same tree is built bottom up by pairing adjacent nodes of each level, where
+// last node of a level having odd width is promoted ( i.e. copied ) to next
+// level as it is. So exactly (leaf_cnt - 1) hashes are computed, while
+// promoted nodes are copied by orchestrator itself, without involving hash
+// engine. Intermediates are placed following compact level layout, see
+// `level_offset`, so `o_size` must be at least `slot_cnt(leaf_cnt) << 5`
+// bytes.
+//
+// Note, nodes are hashed same way as `merklize::merklize` does, i.e. without
+// RFC 6962 style leaf/ node domain separation prefix bytes, so that both of
+// them produce same tree when leaf count is power of 2
+//
+// When there's only one leaf, it's root of tree itself, so it's just copied to
+// slot 1, without hashing
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent in computing all
+// intermediate nodes of binary merkle tree
+sycl::cl_ulong
+merklize_rfc6962(sycl::queue& q,
+                 const size_t leaf_cnt,
+                 uint32_t* const __restrict leaves,
+                 const size_t i_size,
+                 uint32_t* const __restrict intermediates,
+                 const size_t o_size)
+{
+  using Tag = kernelRFC6962Orchestrator;
+
+  assert(leaf_cnt >= 1);
+  assert(i_size >= (leaf_cnt << 5));          // ensure all leaves are present
+  assert(o_size >= (slot_cnt(leaf_cnt) << 5)); // ensure enough memory allocated
+
+  if (leaf_cnt == 1) {
+    sycl::event evt = q.memcpy(intermediates + 8, leaves, 32);
+    evt.wait();
+
+    return time_event(evt);
+  }
+
+  const size_t top = level_cnt(leaf_cnt);
+  const size_t slots = slot_cnt(leaf_cnt);
+
+  engine::launch<Tag>(q, leaf_cnt - 1);
+
+  sycl::event evt = q.single_task<Tag>([=]() {
+    sycl::device_ptr<uint32_t> leaves_ptr{ leaves };
+    sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
+
+    size_t w = leaf_cnt;
+    size_t o_offset = slots;
+
+    // (i+1)-th level is dependent on i-th level, while indexing is done
+    // bottom up
+    for (size_t lvl = 1; lvl <= top; lvl++) {
+      const size_t i_offset = o_offset;
+      const size_t itr_cnt = w >> 1;
+
+      w = (w + 1) >> 1;
+      o_offset -= w;
+
+      if (lvl == 1) {
+        engine::stream<Tag>(
+          itr_cnt,
+          [&](const size_t i) {
+            return engine::load_message(leaves_ptr, i << 4);
+          },
+          [&](const size_t i, const engine::digest_t& dig) {
+            engine::store_digest(intermediates_ptr, (o_offset + i) << 3, dig);
+          });
+      } else {
+        engine::stream<Tag>(
+          itr_cnt,
+          [&](const size_t i) {
+            return engine::load_message(intermediates_ptr,
+                                        (i_offset << 3) + (i << 4));
+          },
+          [&](const size_t i, const engine::digest_t& dig) {
+            engine::store_digest(intermediates_ptr, (o_offset + i) << 3, dig);
+          });
+      }
+
+      // last node of odd width level is promoted to next level
+      if (itr_cnt < w) {
+        const size_t src = itr_cnt << 4;
+        const size_t dst = (o_offset + itr_cnt) << 3;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory access
+        for (size_t j = 0; j < 8; j++) {
+          intermediates_ptr[dst + j] = lvl == 1
+                                         ? leaves_ptr[src + j]
+                                         : intermediates_ptr[(i_offset << 3) +
+                                                             src + j];
+        }
+      }
+    }
+  });
+  evt.wait();
+
+  return time_event(evt);
+}
+
+// Computes all intermediate nodes of Bitcoin style Binary Merkle Tree, where
+// leaf node count is arbitrary ( >= 1 ) & each pair of adjacent nodes is
+// hashed using double SHA256 i.e. SHA256(SHA256(left || right)), while last
+// node of a level having odd width is paired with itself
+//
+// Hash engine chains second ( single message block ) compression of 32 -bytes
+// digest right after 2-to-1 hash, in same pipeline, while odd levels are
+// handled by orchestrator, by reading last node twice. Levels have same width
+// as RFC 6962 style tree has, so intermediates are placed following same
+// compact level layout, see `level_offset`, while `o_size` must be at least
+// `slot_cnt(leaf_cnt) << 5` bytes.
+//
+// Note, Bitcoin transaction identifiers need to be supplied as leaves in their
+// internal byte order ( i.e. reverse of how they're usually displayed ), each
+// of them parsed as 8 big endian words, while root is produced in same form.
+//
+// Block having only coinbase transaction has its identifier as root, so single
+// leaf is just copied to slot 1, without hashing.
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent in computing all
+// intermediate nodes of binary merkle tree
+sycl::cl_ulong
+merklize_sha256d(sycl::queue& q,
+                 const size_t leaf_cnt,
+                 uint32_t* const __restrict leaves,
+                 const size_t i_size,
+                 uint32_t* const __restrict intermediates,
+                 const size_t o_size)
+{
+  using Tag = kernelSHA256dOrchestrator;
+
+  assert(leaf_cnt >= 1);
+  assert(i_size >= (leaf_cnt << 5));          // ensure all leaves are present
+  assert(o_size >= (slot_cnt(leaf_cnt) << 5)); // ensure enough memory allocated
+
+  if (leaf_cnt == 1) {
+    sycl::event evt = q.memcpy(intermediates + 8, leaves, 32);
+    evt.wait();
+
+    return time_event(evt);
+  }
+
+  const size_t top = level_cnt(leaf_cnt);
+  const size_t slots = slot_cnt(leaf_cnt);
+
+  // each node above leaves is computed by hashing, including those having
+  // single child
+  engine::launch<Tag, 64, true>(q, slots - 1);
+
+  sycl::event evt = q.single_task<Tag>([=]() {
+    sycl::device_ptr<uint32_t> leaves_ptr{ leaves };
+    sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
+
+    size_t w = leaf_cnt;
+    size_t o_offset = slots;
+
+    // (i+1)-th level is dependent on i-th level, while indexing is done
+    // bottom up
+    for (size_t lvl = 1; lvl <= top; lvl++) {
+      const size_t i_offset = o_offset << 3;
+      const size_t last = (w - 1) << 3;
+
+      w = (w + 1) >> 1;
+      o_offset -= w;
+
+      // right child of last node of odd width level is its left child itself
+      auto r_off = [&](const size_t i) {
+        return std::min((i << 4) + 8, last);
+      };
+
+      if (lvl == 1) {
+        engine::stream<Tag>(
+          w,
+          [&](const size_t i) {
+            return engine::load_pair(leaves_ptr, i << 4, r_off(i));
+          },
+          [&](const size_t i, const engine::digest_t& dig) {
+            engine::store_digest(intermediates_ptr, (o_offset + i) << 3, dig);
+          });
+      } else {
+        engine::stream<Tag>(
+          w,
+          [&](const size_t i) {
+            return engine::load_pair(
+              intermediates_ptr, i_offset + (i << 4), i_offset + r_off(i));
+          },
+          [&](const size_t i, const engine::digest_t& dig) {
+            engine::store_digest(intermediates_ptr, (o_offset + i) << 3, dig);
+          });
+      }
+    }
+  });
+  evt.wait();
+
+  return time_event(evt);
+}
+
+}
@@ -0,0 +1,192 @@
+#pragma once
+#include "merklize.hpp"
+
+namespace merklize {
+
+// Kernels predeclared to avoid name mangling in optimization report
+//
+// Note, hash engine kernels are named after the orchestrator kernel they
+// are paired with, see `engine::kernelSHA256Hash`
+template<size_t N, size_t idx>
+class kernelInplaceOrchestrator;
+
+template<size_t N>
+class kernelInplaceReduction;
+
+// Layout of intermediate nodes of binary merkle tree, computed in-place i.e.
+// inside buffer holding leaves, by `merklize_inplace`
+//
+// Buffer of `leaf_cnt` slots ( each slot is 32 -bytes wide ) is split into
+// `slice_cnt` equal width slices, one per subtree, where ( with m leaves per
+// slice ) level l of subtree occupies (m >> l) contiguous slots, starting at
+// slot m - (m >> (l - 1)) of its slice. So level 1 overwrites first half of
+// leaves of slice, level 2 overwrites next quarter of them & so on, leaving
+// last slot of each slice free.
+//
+// Levels above subtree roots ( total slice_cnt - 1 nodes ) are kept in those
+// free slots, where i-th node of k-th level above subtree roots lives in last
+// slot of slice (i << k) + (1 << (k - 1)), so that last slot of first slice
+// is never used.
+struct inplace_layout
+{
+  size_t leaf_cnt;
+  size_t slice_width;
+  size_t slice_lvls;
+
+  inplace_layout(const size_t leaf_cnt, const size_t slice_cnt)
+    : leaf_cnt(leaf_cnt)
+    , slice_width(leaf_cnt / slice_cnt)
+    , slice_lvls(bin_log(leaf_cnt / slice_cnt))
+  {}
+
+  // Index of slot, where `idx` -th node of level `lvl` ( >= 1, where leaves are
+  // at level 0 ) lives, in buffer
+  size_t slot(const size_t lvl, const size_t idx) const
+  {
+    const size_t m = slice_width;
+
+    if (lvl <= slice_lvls) {
+      const size_t s = idx >> (slice_lvls - lvl);
+      const size_t i = idx & ((m >> lvl) - 1);
+
+      return s * m + m - (m >> (lvl - 1)) + i;
+    }
+
+    const size_t k = lvl - slice_lvls;
+    const size_t s = (idx << k) + (1ul << (k - 1));
+
+    return s * m + m - 1;
+  }
+
+  // Index of slot, where root of tree lives, in buffer
+  size_t root() const { return slot(bin_log(leaf_cnt), 0); }
+};
+
+// Launches orchestrator kernel ( identified by `Tag` ) along with its hash
+// engine, which computes all levels of `slice_idx` -th subtree ( out of
+// `slice_cnt` ) of binary merkle tree, in-place, following `inplace_layout`
+//
+// Level 1 is written over leaves it's being computed from, which is safe,
+// because i-th digest is written to slot i, only after leaves at slots (2 * i)
+// and (2 * i + 1) are read, see `engine::stream`. Each level above it is
+// written over leaves, which are already consumed.
+template<typename Tag>
+sycl::event
+orchestrate_inplace(sycl::queue& q,
+                    const size_t leaf_cnt,
+                    uint32_t* const buf,
+                    const size_t slice_cnt,
+                    const size_t slice_idx,
+                    const std::vector<sycl::event>& deps = {})
+{
+  // leaves of this slice
+  const size_t m = leaf_cnt / slice_cnt;
+  const size_t base = slice_idx * m;
+
+  engine::launch<Tag>(q, m - 1, deps);
+
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<Tag>([=]() {
+      sycl::device_ptr<uint32_t> buf_ptr{ buf };
+
+      // first slot of level below
+      size_t i_off = base;
+
+      // (i+1)-th level is dependent on i-th level, while indexing is done
+      // bottom up
+      for (size_t lvl = 1, w = m >> 1; w > 0; lvl++, w >>= 1) {
+        const size_t o_off = base + m - (m >> (lvl - 1));
+
+        engine::stream<Tag>(
+          w,
+          [&](const size_t i) {
+            return engine::load_message(buf_ptr, (i_off + (i << 1)) << 3);
+          },
+          [&](const size_t i, const engine::digest_t& dig) {
+            engine::store_digest(buf_ptr, (o_off + i) << 3, dig);
+          });
+
+        i_off = o_off;
+      }
+    });
+  });
+}
+
+// Computes all intermediate nodes of Binary Merkle Tree using SHA256
+// 2-to-1 hash function, where leaf node count is power of 2 value, in-place,
+// i.e. intermediates are written over leaves, in `buf`, so that no separate
+// buffer for intermediates is required, halving device memory requirement
+//
+// Tree is split into N ( power of 2 ) independent subtrees, each computed by
+// its own orchestrator kernel, inside its own slice of `buf`, while top
+// log2(N) levels of tree are finished by a single reduction kernel, once all
+// subtrees are computed. Note, N must be <= (leaf_cnt >> 1).
+//
+// Leaves are consumed in the process, while intermediates are placed
+// following `inplace_layout{ leaf_cnt, N }`, which tells where each of them
+// lives, e.g. root lives at word offset (layout.root() << 3).
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent in computing all
+// intermediate nodes of binary merkle tree
+template<size_t N>
+sycl::cl_ulong
+merklize_inplace(sycl::queue& q,
+                 const size_t leaf_cnt,
+                 uint32_t* const buf,
+                 const size_t size) requires((N > 0) && ((N & (N - 1)) == 0))
+{
+  assert(size >= (leaf_cnt << 5));          // ensure all leaves are present
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  assert(leaf_cnt >= (N << 1));             // ensure each subtree has leaves
+
+  const inplace_layout layout{ leaf_cnt, N };
+
+  std::vector<sycl::event> evts(N);
+
+  [&]<size_t... idx>(std::index_sequence<idx...>)
+  {
+    ((evts[idx] = orchestrate_inplace<kernelInplaceOrchestrator<N, idx>>(
+        q, leaf_cnt, buf, N, idx)),
+     ...);
+  }
+  (std::make_index_sequence<N>{});
+
+  if constexpr (N > 1) {
+    using Tag = kernelInplaceReduction<N>;
+
+    // --- compute top log2(N) levels of merkle tree, including root ---
+    engine::launch<Tag>(q, N - 1, evts);
+
+    evts.push_back(q.submit([&](sycl::handler& h) {
+      h.depends_on(evts);
+
+      h.single_task<Tag>([=]() {
+        sycl::device_ptr<uint32_t> buf_ptr{ buf };
+
+        for (size_t k = 1, w = N >> 1; w > 0; k++, w >>= 1) {
+          const size_t lvl = layout.slice_lvls + k;
+
+          engine::stream<Tag>(
+            w,
+            [&](const size_t i) {
+              return engine::load_pair(buf_ptr,
+                                       layout.slot(lvl - 1, i << 1) << 3,
+                                       layout.slot(lvl - 1, (i << 1) + 1) << 3);
+            },
+            [&](const size_t i, const engine::digest_t& dig) {
+              engine::store_digest(buf_ptr, layout.slot(lvl, i) << 3, dig);
+            });
+        }
+      });
+    }));
+  }
+
+  evts.back().wait();
+
+  return exec_time<N>(evts);
+}
+
+}
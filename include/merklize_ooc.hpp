@@ -0,0 +1,126 @@
+#pragma once
+#include "merklize.hpp"
+#include <cstring>
+
+namespace merklize {
+
+// Computes all intermediate nodes of Binary Merkle Tree using SHA256
+// 2-to-1 hash function, where leaf node count is power of 2 value, while
+// both `leaves` and `intermediates` ( having `leaf_cnt` slots, each slot is 32
+// -bytes wide ) live in host memory, so that tree can be larger than device
+// memory, as long as at most `budget` -bytes of device memory is used
+//
+// Leaves are split into equal width slices, where slice width is largest power
+// of 2, such that four slice sized buffers fit in budget, and each slice is
+// streamed through device, where subtree rooted at it is computed using
+// `merklize_async<N>`. Two pairs of ( leaves, intermediates ) buffers are used
+// in turns, so that transfer of next slice overlaps with computation of
+// current one. Each level of computed subtree is transferred back to where it
+// belongs in `intermediates`, so that roots of all subtrees end up next to
+// each other, as a level of tree. Then tree having those roots as leaves is
+// computed, same way, finishing top levels of tree.
+//
+// So intermediates are placed following same layout as `merklize::merklize`
+// uses, producing identical result. Note, budget must be large enough for
+// slices to have at least (N << 1) leaves.
+//
+// Ensure that SYCL queue has profiling enabled, as at successful completion
+// of this routine it returns time spent in transferring & computing all
+// intermediate nodes of binary merkle tree
+template<size_t N>
+sycl::cl_ulong
+merklize_out_of_core(sycl::queue& q,
+                     const size_t leaf_cnt,
+                     const uint32_t* const __restrict leaves,
+                     uint32_t* const __restrict intermediates,
+                     const size_t budget)
+  requires((N > 0) && ((N & (N - 1)) == 0))
+{
+  assert(leaf_cnt >= 2);
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+
+  // leaves of each slice, such that four slice sized buffers fit in budget
+  size_t m = leaf_cnt;
+  while (m > 1 && (m << 7) > budget) {
+    m >>= 1;
+  }
+
+  assert(m >= (N << 1)); // ensure each subtree of slice has leaves
+
+  const size_t slice_cnt = leaf_cnt / m;
+  const size_t size = m << 5;
+
+  uint32_t* leaves_d[2];
+  uint32_t* intermediates_d[2];
+
+  for (size_t p = 0; p < 2; p++) {
+    leaves_d[p] = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+    intermediates_d[p] = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  }
+
+  // all enqueued commands
+  std::vector<sycl::event> evts;
+  // commands, after which each pair of buffers can be reused
+  std::vector<sycl::event> freed[2];
+  // merklization of previous slice, as all of them share same kernels
+  sycl::event prev;
+
+  for (size_t k = 0; k < slice_cnt; k++) {
+    const size_t p = k & 1;
+
+    sycl::event tx =
+      q.memcpy(leaves_d[p], leaves + k * (m << 3), size, freed[p]);
+
+    std::vector<sycl::event> deps{ tx };
+    if (k > 0) {
+      deps.push_back(prev);
+    }
+
+    prev = merklize_async<N>(
+      q, m, leaves_d[p], size, intermediates_d[p], size, deps);
+
+    evts.push_back(tx);
+    evts.push_back(prev);
+    freed[p].clear();
+
+    // level of subtree having w nodes, belongs to level of tree having
+    // (w * slice_cnt) nodes
+    for (size_t w = 1; w < m; w <<= 1) {
+      const size_t node = w * slice_cnt + k * w;
+
+      sycl::event evt = q.memcpy(intermediates + (node << 3),
+                                 intermediates_d[p] + (w << 3),
+                                 w << 5,
+                                 prev);
+
+      evts.push_back(evt);
+      freed[p].push_back(evt);
+    }
+  }
+
+  for (auto& evt : evts) {
+    evt.wait();
+  }
+
+  for (size_t p = 0; p < 2; p++) {
+    sycl::free(leaves_d[p], q);
+    sycl::free(intermediates_d[p], q);
+  }
+
+  sycl::cl_ulong tm = time_events(evts);
+
+  if (slice_cnt > 1) {
+    // --- compute top log2(slice_cnt) levels of tree, from subtree roots ---
+    uint32_t* top = static_cast<uint32_t*>(std::malloc(slice_cnt << 5));
+
+    tm += merklize_out_of_core<1>(
+      q, slice_cnt, intermediates + (slice_cnt << 3), top, budget);
+    std::memcpy(intermediates + 8, top + 8, (slice_cnt - 1) << 5);
+
+    std::free(top);
+  }
+
+  return tm;
+}
+
+}
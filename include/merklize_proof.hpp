@@ -0,0 +1,426 @@
+#pragma once
+#include "merklize.hpp"
+#include <algorithm>
+
+namespace merklize {
+
+// Kernels predeclared to avoid name mangling in optimization report
+//
+// Note, hash engine kernel is named after the orchestrator kernel it's paired
+// with, see `engine::kernelSHA256Hash`
+class kernelProofExtraction;
+class kernelProofVerification;
+class kernelMultiproofExtraction;
+
+// Gathers inclusion proofs of `proof_cnt` -many leaves, whose indices are
+// given in `idx`, from binary merkle tree with `leaf_cnt` leaves, whose
+// intermediates are computed by `merklize::merklize`, starting after all
+// `deps` complete
+//
+// Proof of leaf is its log2(leaf_cnt) sibling digests, bottom up, i.e. first
+// one is sibling leaf & last one is sibling of root's child, which are packed
+// one after another, so that proof of j-th requested leaf lives at word offset
+// (j * log2(leaf_cnt)) << 3 of `proofs`. Siblings don't need to be hashed, so
+// no hash engine is launched, while kernel just moves 32 -bytes digests from
+// resident tree to `proofs`.
+//
+// `leaves`, `intermediates`, `idx` and `proofs` must all live in device
+// memory, while returned event can be used for chaining transfer of proofs
+// back to host, so that only proofs cross PCIe interface, not whole tree.
+sycl::event
+extract_proofs_async(sycl::queue& q,
+                     const size_t leaf_cnt,
+                     const uint32_t* const __restrict leaves,
+                     const uint32_t* const __restrict intermediates,
+                     const size_t* const __restrict idx,
+                     const size_t proof_cnt,
+                     uint32_t* const __restrict proofs,
+                     const std::vector<sycl::event>& deps = {})
+{
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  assert(leaf_cnt >= 2);
+
+  const size_t depth = bin_log(leaf_cnt);
+
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<kernelProofExtraction>([=]() {
+      sycl::device_ptr<const uint32_t> leaves_ptr{ leaves };
+      sycl::device_ptr<const uint32_t> intermediates_ptr{ intermediates };
+      sycl::device_ptr<const size_t> idx_ptr{ idx };
+      sycl::device_ptr<uint32_t> proofs_ptr{ proofs };
+
+      for (size_t j = 0; j < proof_cnt; j++) {
+        const size_t leaf = idx_ptr[j];
+        const size_t p_off = (j * depth) << 3;
+
+        // sibling leaf lives in `leaves`
+        const size_t l_off = (leaf ^ 1ul) << 3;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read/ write
+        for (size_t k = 0; k < 8; k++) {
+          proofs_ptr[p_off + k] = leaves_ptr[l_off + k];
+        }
+
+        // while siblings above it live in `intermediates`, where node (
+        // 1 based, level order indexing ) m lives at word offset (m << 3)
+        size_t m = (leaf_cnt + leaf) >> 1;
+
+        for (size_t d = 1; d < depth; d++, m >>= 1) {
+          const size_t s_off = (m ^ 1ul) << 3;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read/ write
+          for (size_t k = 0; k < 8; k++) {
+            proofs_ptr[p_off + (d << 3) + k] = intermediates_ptr[s_off + k];
+          }
+        }
+      }
+    });
+  });
+}
+
+// Gathers inclusion proofs of `proof_cnt` -many leaves from binary merkle tree
+// resident in device memory, see `extract_proofs_async`, where leaf indices
+// are given in `idx` and proofs are transferred back to `proofs`, both living
+// in host memory, so `proofs` needs to be (proof_cnt * log2(leaf_cnt)) << 5
+// -bytes
+//
+// Ensure that SYCL queue has profiling enabled, as at successful completion of
+// this routine it returns time spent in gathering inclusion proofs
+sycl::cl_ulong
+extract_proofs(sycl::queue& q,
+               const size_t leaf_cnt,
+               const uint32_t* const __restrict leaves,
+               const uint32_t* const __restrict intermediates,
+               const size_t* const __restrict idx,
+               const size_t proof_cnt,
+               uint32_t* const __restrict proofs)
+{
+  const size_t i_size = proof_cnt * sizeof(size_t);
+  const size_t o_size = (proof_cnt * bin_log(leaf_cnt)) << 5;
+
+  size_t* idx_d = static_cast<size_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* proofs_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+
+  sycl::event evt0 = q.memcpy(idx_d, idx, i_size);
+  sycl::event evt1 = extract_proofs_async(
+    q, leaf_cnt, leaves, intermediates, idx_d, proof_cnt, proofs_d, { evt0 });
+  sycl::event evt2 = q.memcpy(proofs, proofs_d, o_size, evt1);
+  evt2.wait();
+
+  sycl::free(idx_d, q);
+  sycl::free(proofs_d, q);
+
+  return time_event(evt1);
+}
+
+// Verifies `proof_cnt` -many inclusion proofs, each of `depth` sibling
+// digests, where j-th tuple is made of leaf at word offset (j << 3) of
+// `leaves`, proof at word offset (j * depth) << 3 of `proofs` ( packed same
+// way as `extract_proofs_async` does ), leaf index `idx[j]` and expected root
+// at word offset (j << 3) of `roots`, starting after all `deps` complete
+//
+// Each proof is walked bottom up, where bit d of leaf index tells whether
+// running digest is left ( = 0 ) or right ( = 1 ) child at d-th level. As
+// each step of a proof depends on previous one, orchestrator goes level by
+// level, streaming d-th step of all proofs through hash engine, see
+// `engine::stream`, so that independent proofs fill the pipeline. Running
+// digests are kept in `digests` ( proof_cnt * 32 -bytes ), while finally, bit
+// (j & 31) of word (j >> 5) of `bitmap` is set iff j-th computed root matches
+// expected one.
+//
+// All buffers must live in device memory.
+sycl::event
+verify_proofs_async(sycl::queue& q,
+                    const size_t depth,
+                    const uint32_t* const __restrict leaves,
+                    const uint32_t* const __restrict proofs,
+                    const size_t* const __restrict idx,
+                    const uint32_t* const __restrict roots,
+                    const size_t proof_cnt,
+                    uint32_t* const __restrict digests,
+                    uint32_t* const __restrict bitmap,
+                    const std::vector<sycl::event>& deps = {})
+{
+  using Tag = kernelProofVerification;
+
+  assert(depth > 0);
+  assert(proof_cnt > 0);
+
+  engine::launch<Tag>(q, proof_cnt * depth, deps);
+
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<Tag>([=]() {
+      sycl::device_ptr<const uint32_t> leaves_ptr{ leaves };
+      sycl::device_ptr<const uint32_t> proofs_ptr{ proofs };
+      sycl::device_ptr<const size_t> idx_ptr{ idx };
+      sycl::device_ptr<const uint32_t> roots_ptr{ roots };
+      sycl::device_ptr<uint32_t> digests_ptr{ digests };
+      sycl::device_ptr<uint32_t> bitmap_ptr{ bitmap };
+
+      auto store = [&](const size_t j, const engine::digest_t& dig) {
+        engine::store_digest(digests_ptr, j << 3, dig);
+      };
+
+      // (d+1)-th step of each proof is dependent on its d-th step
+      for (size_t d = 0; d < depth; d++) {
+        auto load = [&](const size_t j, auto ptr) {
+          const size_t s_off = (j * depth + d) << 3;
+          const bool right = (idx_ptr[j] >> d) & 1ul;
+
+          engine::message_t msg;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read
+          for (size_t k = 0; k < 8; k++) {
+            const uint32_t node = ptr[(j << 3) + k];
+            const uint32_t sibling = proofs_ptr[s_off + k];
+
+            msg.words[k] = right ? sibling : node;
+            msg.words[8 + k] = right ? node : sibling;
+          }
+
+          return msg;
+        };
+
+        if (d == 0) {
+          engine::stream<Tag>(
+            proof_cnt,
+            [&](const size_t j) { return load(j, leaves_ptr); },
+            store);
+        } else {
+          engine::stream<Tag>(
+            proof_cnt,
+            [&](const size_t j) { return load(j, digests_ptr); },
+            store);
+        }
+      }
+
+      uint32_t word = 0;
+
+      for (size_t j = 0; j < proof_cnt; j++) {
+        bool ok = true;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read
+        for (size_t k = 0; k < 8; k++) {
+          ok &= digests_ptr[(j << 3) + k] == roots_ptr[(j << 3) + k];
+        }
+
+        word |= static_cast<uint32_t>(ok) << (j & 31ul);
+
+        if ((j & 31ul) == 31ul || j == proof_cnt - 1) {
+          bitmap_ptr[j >> 5] = word;
+          word = 0;
+        }
+      }
+    });
+  });
+}
+
+// Verifies `proof_cnt` -many inclusion proofs, each of `depth` sibling
+// digests, see `verify_proofs_async`, where all inputs & `bitmap` ( of
+// (proof_cnt + 31) >> 5 words ) live in host memory, so that they're
+// transferred to/ from device
+//
+// Ensure that SYCL queue has profiling enabled, as at successful completion of
+// this routine it returns time spent in verifying inclusion proofs
+sycl::cl_ulong
+verify_proofs(sycl::queue& q,
+              const size_t depth,
+              const uint32_t* const __restrict leaves,
+              const uint32_t* const __restrict proofs,
+              const size_t* const __restrict idx,
+              const uint32_t* const __restrict roots,
+              const size_t proof_cnt,
+              uint32_t* const __restrict bitmap)
+{
+  const size_t d_size = proof_cnt << 5;
+  const size_t p_size = (proof_cnt * depth) << 5;
+  const size_t i_size = proof_cnt * sizeof(size_t);
+  const size_t b_size = ((proof_cnt + 31) >> 5) << 2;
+
+  uint32_t* leaves_d = static_cast<uint32_t*>(sycl::malloc_device(d_size, q));
+  uint32_t* proofs_d = static_cast<uint32_t*>(sycl::malloc_device(p_size, q));
+  size_t* idx_d = static_cast<size_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* roots_d = static_cast<uint32_t*>(sycl::malloc_device(d_size, q));
+  uint32_t* digests_d = static_cast<uint32_t*>(sycl::malloc_device(d_size, q));
+  uint32_t* bitmap_d = static_cast<uint32_t*>(sycl::malloc_device(b_size, q));
+
+  std::vector<sycl::event> txs{ q.memcpy(leaves_d, leaves, d_size),
+                                q.memcpy(proofs_d, proofs, p_size),
+                                q.memcpy(idx_d, idx, i_size),
+                                q.memcpy(roots_d, roots, d_size) };
+
+  sycl::event evt0 = verify_proofs_async(q,
+                                         depth,
+                                         leaves_d,
+                                         proofs_d,
+                                         idx_d,
+                                         roots_d,
+                                         proof_cnt,
+                                         digests_d,
+                                         bitmap_d,
+                                         txs);
+  sycl::event evt1 = q.memcpy(bitmap, bitmap_d, b_size, evt0);
+  evt1.wait();
+
+  sycl::free(leaves_d, q);
+  sycl::free(proofs_d, q);
+  sycl::free(idx_d, q);
+  sycl::free(roots_d, q);
+  sycl::free(digests_d, q);
+  sycl::free(bitmap_d, q);
+
+  return time_event(evt0);
+}
+
+// Layout of multiproof i.e. minimal set of nodes of binary merkle tree with
+// `leaf_cnt` leaves, required for verifying inclusion of a set of leaves at
+// once, which doesn't repeat siblings shared by paths of those leaves
+//
+// Nodes are identified by their index in level order ( 1 based ), where root
+// is node 1, node m has children 2m & (2m + 1), while i-th leaf is node
+// (leaf_cnt + i). Going level by level, bottom up, sibling of each node known
+// to verifier is required, unless verifier already knows it too, while parents
+// of known nodes become known, for next level. So `nodes` lists required nodes
+// level by level, bottom up, in increasing order in each level, which is same
+// order, verifier consumes them in.
+struct multiproof_layout
+{
+  size_t leaf_cnt;
+  std::vector<size_t> nodes;
+
+  // Empty layout, whose nodes are to be filled in by caller, see
+  // `range_layout`
+  explicit multiproof_layout(const size_t leaf_cnt)
+    : leaf_cnt(leaf_cnt)
+  {}
+
+  // Computes layout of multiproof of `idx_cnt` -many leaves, whose strictly
+  // increasing indices are given in `idx`
+  multiproof_layout(const size_t leaf_cnt,
+                    const size_t* const idx,
+                    const size_t idx_cnt)
+    : leaf_cnt(leaf_cnt)
+  {
+    assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+    assert(leaf_cnt >= 2);
+    assert(idx_cnt > 0);
+    // ensure leaves are sorted & not repeated
+    assert(std::adjacent_find(idx, idx + idx_cnt, std::greater_equal<>()) ==
+           idx + idx_cnt);
+    assert(idx[idx_cnt - 1] < leaf_cnt);
+
+    std::vector<size_t> known(idx_cnt);
+    for (size_t i = 0; i < idx_cnt; i++) {
+      known[i] = leaf_cnt + idx[i];
+    }
+
+    while (known[0] > 1) {
+      std::vector<size_t> parents;
+
+      for (size_t i = 0; i < known.size(); i++) {
+        const size_t m = known[i];
+
+        if (i + 1 < known.size() && known[i + 1] == (m ^ 1ul)) {
+          // both siblings are known, so none is required
+          i++;
+        } else {
+          nodes.push_back(m ^ 1ul);
+        }
+
+        parents.push_back(m >> 1);
+      }
+
+      known = std::move(parents);
+    }
+  }
+
+  // Size of multiproof in bytes, as each node is 32 -bytes digest
+  size_t size() const { return nodes.size() << 5; }
+};
+
+// Gathers `node_cnt` -many nodes, whose indices ( in level order, see
+// `multiproof_layout` ) are given in `nodes`, from binary merkle tree with
+// `leaf_cnt` leaves, whose intermediates are computed by `merklize::merklize`,
+// packing them one after another in `proof`, starting after all `deps`
+// complete
+//
+// `leaves`, `intermediates`, `nodes` and `proof` must all live in device
+// memory.
+sycl::event
+extract_multiproof_async(sycl::queue& q,
+                         const size_t leaf_cnt,
+                         const uint32_t* const __restrict leaves,
+                         const uint32_t* const __restrict intermediates,
+                         const size_t* const __restrict nodes,
+                         const size_t node_cnt,
+                         uint32_t* const __restrict proof,
+                         const std::vector<sycl::event>& deps = {})
+{
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<kernelMultiproofExtraction>([=]() {
+      sycl::device_ptr<const uint32_t> leaves_ptr{ leaves };
+      sycl::device_ptr<const uint32_t> intermediates_ptr{ intermediates };
+      sycl::device_ptr<const size_t> nodes_ptr{ nodes };
+      sycl::device_ptr<uint32_t> proof_ptr{ proof };
+
+      for (size_t j = 0; j < node_cnt; j++) {
+        const size_t m = nodes_ptr[j];
+        const bool leaf = m >= leaf_cnt;
+        const size_t off = (leaf ? m - leaf_cnt : m) << 3;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read/ write
+        for (size_t k = 0; k < 8; k++) {
+          proof_ptr[(j << 3) + k] =
+            leaf ? leaves_ptr[off + k] : intermediates_ptr[off + k];
+        }
+      }
+    });
+  });
+}
+
+// Gathers multiproof of a set of leaves from binary merkle tree resident in
+// device memory, following `layout`, see `extract_multiproof_async`, where
+// `proof` lives in host memory & needs to be `layout.size()` -bytes, so that
+// only required nodes cross PCIe interface
+//
+// Ensure that SYCL queue has profiling enabled, as at successful completion of
+// this routine it returns time spent in gathering multiproof
+sycl::cl_ulong
+extract_multiproof(sycl::queue& q,
+                   const uint32_t* const __restrict leaves,
+                   const uint32_t* const __restrict intermediates,
+                   const multiproof_layout& layout,
+                   uint32_t* const __restrict proof)
+{
+  const size_t node_cnt = layout.nodes.size();
+  const size_t i_size = node_cnt * sizeof(size_t);
+  const size_t o_size = layout.size();
+
+  size_t* nodes_d = static_cast<size_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* proof_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+
+  sycl::event evt0 = q.memcpy(nodes_d, layout.nodes.data(), i_size);
+  sycl::event evt1 = extract_multiproof_async(q,
+                                              layout.leaf_cnt,
+                                              leaves,
+                                              intermediates,
+                                              nodes_d,
+                                              node_cnt,
+                                              proof_d,
+                                              { evt0 });
+  sycl::event evt2 = q.memcpy(proof, proof_d, o_size, evt1);
+  evt2.wait();
+
+  sycl::free(nodes_d, q);
+  sycl::free(proof_d, q);
+
+  return time_event(evt1);
+}
+
+}
@@ -0,0 +1,223 @@
+#pragma once
+#include "merklize_proof.hpp"
+
+namespace merklize {
+
+// Kernel predeclared to avoid name mangling in optimization report
+//
+// Note, its hash engine kernel is named after it, see
+// `engine::kernelSHA256Hash`
+class kernelRangeVerification;
+
+// Computes layout of range proof of leaves [a, b) of binary merkle tree with
+// `leaf_cnt` leaves, which is same as `multiproof_layout` of those leaves,
+// but computed in O(log2(leaf_cnt)) time, without enumerating leaves
+//
+// As known nodes of each level form a contiguous range [lo, hi), only nodes
+// at its boundaries can have unknown siblings, so proof has at most two nodes
+// per level, left boundary's sibling ( when lo is odd ) followed by right
+// boundary's sibling ( when hi is odd ). Subtrees fully covered by range need
+// no proof nodes at all, as verifier rebuilds their roots from leaves [a, b).
+//
+// Use `extract_multiproof` for gathering proof, following this layout.
+multiproof_layout
+range_layout(const size_t leaf_cnt, const size_t a, const size_t b)
+{
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  assert(leaf_cnt >= 2);
+  assert(a < b && b <= leaf_cnt); // ensure non-empty range
+
+  multiproof_layout layout{ leaf_cnt };
+
+  for (size_t w = leaf_cnt, lo = a, hi = b; w > 1; w >>= 1) {
+    if ((lo & 1ul) == 1ul) {
+      layout.nodes.push_back(w + lo - 1);
+    }
+    if ((hi & 1ul) == 1ul) {
+      layout.nodes.push_back(w + hi);
+    }
+
+    lo >>= 1;
+    hi = (hi + 1) >> 1;
+  }
+
+  return layout;
+}
+
+// Verifies range proof of leaves [a, b) of binary merkle tree with `leaf_cnt`
+// leaves, by rebuilding root from contiguous slice of leaves ( i-th leaf of
+// slice at word offset (i << 3) of `slice` ) & nodes of `proof`, packed
+// following `range_layout`, starting after all `deps` complete. Finally
+// `ok` is set to 1 iff rebuilt root matches 8 words at `root`, otherwise 0.
+//
+// Orchestrator goes level by level, hashing known range of each level,
+// extended with its boundary siblings taken from proof, into known range of
+// next level, see `engine::stream`. So it computes (b - a) + O(log2(leaf_cnt))
+// hashes, instead of (b - a) * log2(leaf_cnt). Known range of each level above
+// leaves is kept in `scratch` ( (b - a) * 32 -bytes ), written over level
+// below, which is safe, because i-th node is written to slot i, only after
+// slots >= 2 * i are read.
+//
+// All buffers must live in device memory.
+sycl::event
+verify_range_async(sycl::queue& q,
+                   const size_t leaf_cnt,
+                   const size_t a,
+                   const size_t b,
+                   const uint32_t* const __restrict slice,
+                   const uint32_t* const __restrict proof,
+                   const uint32_t* const __restrict root,
+                   uint32_t* const __restrict scratch,
+                   uint32_t* const __restrict ok,
+                   const std::vector<sycl::event>& deps = {})
+{
+  using Tag = kernelRangeVerification;
+
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  assert(leaf_cnt >= 2);
+  assert(a < b && b <= leaf_cnt); // ensure non-empty range
+
+  // nodes of all levels above leaves, rebuilt from range
+  size_t msg_cnt = 0;
+  for (size_t w = leaf_cnt, lo = a, hi = b; w > 1; w >>= 1) {
+    lo >>= 1;
+    hi = (hi + 1) >> 1;
+    msg_cnt += hi - lo;
+  }
+
+  engine::launch<Tag>(q, msg_cnt, deps);
+
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<Tag>([=]() {
+      sycl::device_ptr<const uint32_t> slice_ptr{ slice };
+      sycl::device_ptr<const uint32_t> proof_ptr{ proof };
+      sycl::device_ptr<const uint32_t> root_ptr{ root };
+      sycl::device_ptr<uint32_t> scratch_ptr{ scratch };
+      sycl::device_ptr<uint32_t> ok_ptr{ ok };
+
+      // next node of proof, to be consumed
+      size_t p_idx = 0;
+
+      size_t lo = a;
+      size_t hi = b;
+
+      // (i+1)-th level is dependent on i-th level, while indexing is done
+      // bottom up
+      for (size_t w = leaf_cnt; w > 1; w >>= 1) {
+        const bool has_l = (lo & 1ul) == 1ul;
+        const bool has_r = (hi & 1ul) == 1ul;
+
+        const size_t l_off = p_idx << 3;
+        const size_t r_off = (p_idx + has_l) << 3;
+        p_idx += has_l + has_r;
+
+        // first node of known range, extended with left boundary's sibling
+        const size_t first = lo & ~1ul;
+        const size_t cnt = ((hi + 1) >> 1) - (lo >> 1);
+
+        // word offset of node c of this level, in given known range or proof
+        auto node_off = [&](const size_t c, bool& in_proof) {
+          in_proof = c < lo || c >= hi;
+          return c < lo ? l_off : c >= hi ? r_off : (c - lo) << 3;
+        };
+
+        auto load = [&](const size_t i, auto ptr) {
+          bool l_proof, r_proof;
+
+          const size_t c = first + (i << 1);
+          const size_t l = node_off(c, l_proof);
+          const size_t r = node_off(c + 1, r_proof);
+
+          engine::message_t msg;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read
+          for (size_t k = 0; k < 8; k++) {
+            msg.words[k] = l_proof ? proof_ptr[l + k] : ptr[l + k];
+            msg.words[8 + k] = r_proof ? proof_ptr[r + k] : ptr[r + k];
+          }
+
+          return msg;
+        };
+
+        auto store = [&](const size_t i, const engine::digest_t& dig) {
+          engine::store_digest(scratch_ptr, i << 3, dig);
+        };
+
+        if (w == leaf_cnt) {
+          engine::stream<Tag>(
+            cnt, [&](const size_t i) { return load(i, slice_ptr); }, store);
+        } else {
+          engine::stream<Tag>(
+            cnt, [&](const size_t i) { return load(i, scratch_ptr); }, store);
+        }
+
+        lo >>= 1;
+        hi = (hi + 1) >> 1;
+      }
+
+      bool matched = true;
+
+#pragma unroll 8
+      for (size_t k = 0; k < 8; k++) {
+        matched &= scratch_ptr[k] == root_ptr[k];
+      }
+
+      ok_ptr[0] = static_cast<uint32_t>(matched);
+    });
+  });
+}
+
+// Verifies range proof of leaves [a, b) of binary merkle tree with `leaf_cnt`
+// leaves, see `verify_range_async`, where leaves of range, proof ( of
+// `range_layout(leaf_cnt, a, b).size()` -bytes ) and expected root live in
+// host memory, so that they're transferred to device, while `ok` is set iff
+// proof verifies
+//
+// Ensure that SYCL queue has profiling enabled, as at successful completion of
+// this routine it returns time spent in verifying range proof
+sycl::cl_ulong
+verify_range(sycl::queue& q,
+             const size_t leaf_cnt,
+             const size_t a,
+             const size_t b,
+             const uint32_t* const __restrict slice,
+             const uint32_t* const __restrict proof,
+             const uint32_t* const __restrict root,
+             bool* const ok)
+{
+  const size_t s_size = (b - a) << 5;
+  const size_t p_size = range_layout(leaf_cnt, a, b).size();
+
+  uint32_t* slice_d = static_cast<uint32_t*>(sycl::malloc_device(s_size, q));
+  // at least one slot, as proof of whole tree is empty
+  uint32_t* proof_d =
+    static_cast<uint32_t*>(sycl::malloc_device(std::max(p_size, 32ul), q));
+  uint32_t* root_d = static_cast<uint32_t*>(sycl::malloc_device(32, q));
+  uint32_t* scratch_d = static_cast<uint32_t*>(sycl::malloc_device(s_size, q));
+  uint32_t* ok_d = static_cast<uint32_t*>(sycl::malloc_device(4, q));
+
+  std::vector<sycl::event> txs{ q.memcpy(slice_d, slice, s_size),
+                                q.memcpy(proof_d, proof, p_size),
+                                q.memcpy(root_d, root, 32) };
+
+  sycl::event evt0 = verify_range_async(
+    q, leaf_cnt, a, b, slice_d, proof_d, root_d, scratch_d, ok_d, txs);
+
+  uint32_t ok_h = 0;
+  sycl::event evt1 = q.memcpy(&ok_h, ok_d, 4, evt0);
+  evt1.wait();
+
+  sycl::free(slice_d, q);
+  sycl::free(proof_d, q);
+  sycl::free(root_d, q);
+  sycl::free(scratch_d, q);
+  sycl::free(ok_d, q);
+
+  *ok = ok_h == 1;
+
+  return time_event(evt0);
+}
+
+}
@@ -0,0 +1,119 @@
+#pragma once
+#include "merklize.hpp"
+
+namespace merklize {
+
+// Kernels predeclared to avoid name mangling in optimization report
+//
+// Note, hash engine kernels are named after the orchestrator kernel they
+// are paired with, see `engine::kernelSHA256Hash`
+template<size_t parity>
+class kernelStreamedChunkOrchestrator;
+
+class kernelStreamedReduction;
+
+// Computes all intermediate nodes of Binary Merkle Tree using SHA256
+// 2-to-1 hash function, where leaf node count is power of 2 value, while
+// leaves live in host memory & are transferred to device in `chunk_cnt`
+// equal sized chunks, overlapping transfer with hashing
+//
+// Two device buffers, each holding one chunk of leaves, are used in turns, so
+// that while subtree rooted at k-th chunk is being computed from one of them,
+// (k+1)-th chunk is being transferred to the other one. k-th chunk is
+// transferred only after subtree of (k-2)-th chunk, which used same buffer,
+// has been computed. Each buffer gets its own orchestrator & hash engine pair.
+// Once all chunk subtrees are computed, top log2(chunk_cnt) levels of tree are
+// finished by a single reduction kernel. Intermediates are placed in same
+// layout as `merklize::merklize` does, in device memory.
+//
+// So end-to-end time approaches max(transfer, compute), instead of their sum,
+// when chunks are small enough. Note, `chunk_cnt` must be power of 2, such
+// that 2 <= chunk_cnt <= (leaf_cnt >> 1).
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent from start of first
+// transfer to end of computation of all intermediate nodes of binary merkle
+// tree
+sycl::cl_ulong
+merklize_streamed(sycl::queue& q,
+                  const size_t leaf_cnt,
+                  const uint32_t* const __restrict leaves,
+                  const size_t i_size,
+                  uint32_t* const __restrict intermediates,
+                  const size_t o_size,
+                  const size_t chunk_cnt)
+{
+  assert(i_size == o_size);                   // ensure enough memory allocated
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0);   // ensure power of 2
+  assert((chunk_cnt & (chunk_cnt - 1)) == 0); // ensure power of 2
+  assert(chunk_cnt >= 2);                     // ensure double buffering
+  assert(leaf_cnt >= (chunk_cnt << 1));       // ensure each chunk has leaves
+
+  const size_t chunk_size = i_size / chunk_cnt;
+  const size_t chunk_words = chunk_size >> 2;
+
+  uint32_t* bufs[2] = {
+    static_cast<uint32_t*>(sycl::malloc_device(chunk_size, q)),
+    static_cast<uint32_t*>(sycl::malloc_device(chunk_size, q)),
+  };
+
+  std::vector<sycl::event> evts;
+  sycl::event hashed[2];
+
+  for (size_t k = 0; k < chunk_cnt; k++) {
+    const size_t p = k & 1;
+
+    // buffer is reused only after its previous chunk has been hashed
+    std::vector<sycl::event> deps;
+    if (k >= 2) {
+      deps.push_back(hashed[p]);
+    }
+
+    sycl::event tx = q.submit([&](sycl::handler& h) {
+      h.depends_on(deps);
+      h.memcpy(bufs[p], leaves + k * chunk_words, chunk_size);
+    });
+
+    // computes subtree rooted at k-th chunk, using orchestrator & hash engine
+    // pair dedicated to buffer it lives in
+    auto hash_chunk = [&]<size_t parity>() {
+      return orchestrate<kernelStreamedChunkOrchestrator<parity>, 0, true>(
+        q,
+        leaf_cnt,
+        bufs[parity],
+        intermediates,
+        leaf_cnt >> 1,
+        chunk_cnt,
+        chunk_cnt,
+        k,
+        { tx });
+    };
+
+    hashed[p] = p == 0 ? hash_chunk.template operator()<0>()
+                       : hash_chunk.template operator()<1>();
+
+    evts.push_back(tx);
+    evts.push_back(hashed[p]);
+  }
+
+  // --- compute top log2(chunk_cnt) levels of merkle tree, including root ---
+  sycl::event evt =
+    orchestrate<kernelStreamedReduction>(q,
+                                         leaf_cnt,
+                                         bufs[0],
+                                         intermediates,
+                                         chunk_cnt >> 1,
+                                         1,
+                                         1,
+                                         0,
+                                         { hashed[0], hashed[1] });
+  evt.wait();
+  evts.push_back(evt);
+
+  sycl::free(bufs[0], q);
+  sycl::free(bufs[1], q);
+
+  return time_events(evts);
+}
+
+}
@@ -0,0 +1,137 @@
+#pragma once
+#include "merklize.hpp"
+
+namespace merklize {
+
+// Kernels predeclared to avoid name mangling in optimization report
+//
+// Note, hash engine kernels are named after the stage kernel they are paired
+// with, see `engine::kernelSHA256Hash`
+template<size_t S, size_t lvl>
+class kernelSystolicStage;
+
+template<size_t S>
+class kernelSystolicReduction;
+
+template<typename Tag>
+class pipeLinkId;
+
+// Digests computed by stage kernel ( identified by `Tag` ) are streamed over
+// this pipe to the stage kernel computing next level, which pairs adjacent
+// ones as its input messages
+template<typename Tag>
+using link_pipe =
+  sycl::ext::intel::pipe<pipeLinkId<Tag>, engine::digest_t, engine::PIPE_DEPTH>;
+
+// Launches stage kernel ( along with its hash engine ) computing level `lvl` (
+// >= 1 ) of binary merkle tree with `leaf_cnt` leaves, out of S levels
+// computed by stage kernels
+//
+// First stage reads its messages from `leaves`, while others receive them
+// from previous stage, over link pipe. Each computed digest is written to its
+// slot in `intermediates` & unless this is last stage, also sent to next
+// stage, so that all stages run concurrently.
+template<size_t S, size_t lvl>
+sycl::event
+stage(sycl::queue& q,
+      const size_t leaf_cnt,
+      uint32_t* const __restrict leaves,
+      uint32_t* const __restrict intermediates) requires(lvl > 0 && lvl <= S)
+{
+  using Tag = kernelSystolicStage<S, lvl>;
+  using Prev = kernelSystolicStage<S, lvl - 1>;
+
+  // width of level computed by this stage
+  const size_t w = leaf_cnt >> lvl;
+
+  engine::launch<Tag>(q, w);
+
+  return q.single_task<Tag>([=]() {
+    sycl::device_ptr<uint32_t> leaves_ptr{ leaves };
+    sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
+
+    engine::stream<Tag>(
+      w,
+      [&](const size_t i) {
+        if constexpr (lvl == 1) {
+          return engine::load_message(leaves_ptr, i << 4);
+        } else {
+          const engine::digest_t l = link_pipe<Prev>::read();
+          const engine::digest_t r = link_pipe<Prev>::read();
+
+          engine::message_t msg;
+
+#pragma unroll 8
+          for (size_t j = 0; j < 8; j++) {
+            msg.words[j] = l.words[j];
+            msg.words[8 + j] = r.words[j];
+          }
+
+          return msg;
+        }
+      },
+      [&](const size_t i, const engine::digest_t& dig) {
+        engine::store_digest(intermediates_ptr, (w + i) << 3, dig);
+
+        if constexpr (lvl < S) {
+          link_pipe<Tag>::write(dig);
+        }
+      });
+  });
+}
+
+// Computes all intermediate nodes of Binary Merkle Tree using SHA256
+// 2-to-1 hash function, where leaf node count is power of 2 value, placing
+// them in same layout as `merklize::merklize` does
+//
+// Instead of a single orchestrator walking tree level by level, lowest S
+// levels are computed by S stage kernels ( each paired with its own hash
+// engine ), one per level, connected by SYCL pipes in systolic fashion. Every
+// stage streams its digests directly into next stage, so a level starts being
+// hashed as soon as first pair of its children is available, without waiting
+// for whole level below it to be written to global memory. Levels above those
+// are narrow, so they're finished by a single reduction kernel, reading from
+// global memory, see `orchestrate`.
+//
+// All stages hash concurrently, so latency approaches time spent in hashing
+// leaf level, instead of sum over all levels, at cost of S hash engines worth
+// of FPGA area. Note, S must be <= log2(leaf_cnt).
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent in computing all
+// intermediate nodes of binary merkle tree
+template<size_t S>
+sycl::cl_ulong
+merklize_systolic(sycl::queue& q,
+                  const size_t leaf_cnt,
+                  uint32_t* const __restrict leaves,
+                  const size_t i_size,
+                  uint32_t* const __restrict intermediates,
+                  const size_t o_size) requires(S > 0)
+{
+  assert(i_size == o_size);                 // ensure enough memory allocated
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  assert(leaf_cnt >= (1ul << S));           // ensure each stage has a level
+
+  std::vector<sycl::event> evts(S);
+
+  [&]<size_t... idx>(std::index_sequence<idx...>)
+  {
+    ((evts[idx] = stage<S, idx + 1>(q, leaf_cnt, leaves, intermediates)), ...);
+  }
+  (std::make_index_sequence<S>{});
+
+  if (leaf_cnt > (1ul << S)) {
+    // --- compute levels above those computed by stages, including root ---
+    evts.push_back(orchestrate<kernelSystolicReduction<S>>(
+      q, leaf_cnt, leaves, intermediates, leaf_cnt >> (S + 1), 1, 1, 0, evts));
+  }
+
+  for (auto& evt : evts) {
+    evt.wait();
+  }
+
+  return time_events(evts);
+}
+
+}
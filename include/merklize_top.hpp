@@ -0,0 +1,222 @@
+#pragma once
+#include "merklize.hpp"
+
+namespace merklize {
+
+// Kernels predeclared to avoid name mangling in optimization report
+//
+// Note, hash engine kernels are named after the orchestrator kernel they
+// are paired with, see `engine::kernelSHA256Hash`
+template<size_t N, size_t idx, size_t tile_log>
+class kernelTopLevelsOrchestrator;
+
+template<size_t N, size_t tile_log>
+class kernelTopLevelsReduction;
+
+// Launches orchestrator kernel ( identified by `Tag` ) along with its hash
+// engine, which computes roots of `slice_idx` -th slice ( out of `slice_cnt`
+// ) of `root_cnt` equal sized, consecutive subtrees of binary merkle tree,
+// writing i-th root at word offset ((root_cnt + i) << 3) of `top`, while
+// nothing below those roots is written to global memory
+//
+// Each subtree is computed tile by tile, where all `tile_log` levels of a
+// tile's subtree are computed in on-chip memory, see `orchestrate`, while
+// tile roots are combined using an on-chip stack, having one pending node per
+// level, just like incrementing a binary counter, so that root of subtree is
+// available as soon as its last tile is computed. Combining tile roots is
+// latency bound, but there are only 1/2^tile_log as many of them, as leaves.
+template<typename Tag, size_t tile_log>
+sycl::event
+orchestrate_roots(sycl::queue& q,
+                  const size_t leaf_cnt,
+                  uint32_t* const __restrict leaves,
+                  uint32_t* const __restrict top,
+                  const size_t root_cnt,
+                  const size_t slice_cnt,
+                  const size_t slice_idx,
+                  const std::vector<sycl::event>& deps = {})
+  requires(tile_log > 0)
+{
+  // subtrees computed by this orchestrator
+  const size_t sub_cnt = root_cnt / slice_cnt;
+  // leaves of each subtree
+  const size_t sub_width = leaf_cnt / root_cnt;
+  // tiles of each subtree
+  const size_t tile_cnt = sub_width >> tile_log;
+
+  engine::launch<Tag>(q, sub_cnt * (sub_width - 1), deps);
+
+  return q.submit([&](sycl::handler& h) {
+    h.depends_on(deps);
+
+    h.single_task<Tag>([=]() {
+      sycl::device_ptr<uint32_t> leaves_ptr{ leaves };
+      sycl::device_ptr<uint32_t> top_ptr{ top };
+
+      // tile's subtree, in level order, where m-th node ( 1 based indexing )
+      // lives at word offset (m << 3), same as `intermediates`
+      [[intel::fpga_memory("BLOCK_RAM")]] uint32_t tile[8ul << tile_log];
+
+      // pending node of each level, above tile roots
+      [[intel::fpga_memory("BLOCK_RAM")]] uint32_t stack[8ul << 6];
+
+      for (size_t s = 0; s < sub_cnt; s++) {
+        const size_t sub_idx = slice_idx * sub_cnt + s;
+
+        engine::digest_t node;
+
+        for (size_t t = 0; t < tile_cnt; t++) {
+          const size_t l_off = ((sub_idx * tile_cnt + t) << tile_log) << 3;
+
+          // (i+1)-th level of tile is dependent on i-th level of tile, while
+          // indexing is done bottom up
+          for (size_t j = 1; j <= tile_log; j++) {
+            const size_t itr_cnt = 1ul << (tile_log - j);
+
+            auto store = [&](const size_t i, const engine::digest_t& dig) {
+              engine::store_digest(tile, (itr_cnt + i) << 3, dig);
+            };
+
+            if (j == 1) {
+              engine::stream<Tag>(
+                itr_cnt,
+                [&](const size_t i) {
+                  return engine::load_message(leaves_ptr, l_off + (i << 4));
+                },
+                store);
+            } else {
+              engine::stream<Tag>(
+                itr_cnt,
+                [&](const size_t i) {
+                  return engine::load_message(tile, (itr_cnt + i) << 4);
+                },
+                store);
+            }
+          }
+
+#pragma unroll 8
+          for (size_t k = 0; k < 8; k++) {
+            node.words[k] = tile[8 + k];
+          }
+
+          // t-th tile root is combined with as many pending nodes, as there
+          // are trailing set bits in t
+          size_t lvl = 0;
+          for (size_t c = t; (c & 1) == 1; c >>= 1, lvl++) {
+            engine::message_t msg;
+
+#pragma unroll 8
+            for (size_t k = 0; k < 8; k++) {
+              msg.words[k] = stack[(lvl << 3) + k];
+              msg.words[8 + k] = node.words[k];
+            }
+
+            engine::message_pipe<Tag>::write(msg);
+            node = engine::digest_pipe<Tag>::read();
+          }
+
+          engine::store_digest(stack, lvl << 3, node);
+        }
+
+        // after last tile, pending node of topmost level is subtree root
+        engine::store_digest(top_ptr, (root_cnt + sub_idx) << 3, node);
+      }
+    });
+  });
+}
+
+// Computes only top K levels of Binary Merkle Tree ( i.e. levels having 1, 2,
+// 4, ..., 2^(K-1) nodes ) using SHA256 2-to-1 hash function, where leaf node
+// count is power of 2 value, writing them to `top`, following same layout as
+// `merklize::merklize` uses, so that `top` needs to be only 2^K slots ( each
+// slot is 32 -bytes wide ), instead of `leaf_cnt` slots. E.g. setting K = 1
+// computes just the root, at slot 1.
+//
+// Nodes of level having 2^(K-1) nodes are computed as roots of as many
+// subtrees, split among N ( power of 2 ) orchestrators, which compute every
+// level below those roots in on-chip memory, tile by tile, where each tile has
+// 2^TILE_LOG leaves, see `orchestrate_roots`. Remaining top (K - 1) levels are
+// finished by a single reduction kernel. Note, 2^(K-1) must be >= N, while
+// each subtree must have at least 2^TILE_LOG leaves.
+//
+// Use `read_top_levels` for transferring computed levels back to host.
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent in computing top K
+// levels of binary merkle tree
+template<size_t N, size_t TILE_LOG>
+sycl::cl_ulong
+merklize_top_levels(sycl::queue& q,
+                    const size_t leaf_cnt,
+                    uint32_t* const __restrict leaves,
+                    const size_t i_size,
+                    uint32_t* const __restrict top,
+                    const size_t o_size,
+                    const size_t K)
+  requires((N > 0) && ((N & (N - 1)) == 0) && (TILE_LOG > 0))
+{
+  assert(K > 0);
+
+  // nodes of lowest level, among top K levels
+  const size_t root_cnt = 1ul << (K - 1);
+
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0);   // ensure power of 2
+  assert(i_size >= (leaf_cnt << 5));          // ensure all leaves are present
+  assert(o_size >= (root_cnt << 6));          // ensure enough memory allocated
+  assert(root_cnt >= N);                      // ensure each slice has subtrees
+  assert(leaf_cnt >= (root_cnt << TILE_LOG)); // ensure each subtree has tiles
+
+  std::vector<sycl::event> evts(N);
+
+  [&]<size_t... idx>(std::index_sequence<idx...>)
+  {
+    ((evts[idx] =
+        orchestrate_roots<kernelTopLevelsOrchestrator<N, idx, TILE_LOG>,
+                          TILE_LOG>(
+          q, leaf_cnt, leaves, top, root_cnt, N, idx)),
+     ...);
+  }
+  (std::make_index_sequence<N>{});
+
+  sycl::cl_ulong reduction_tm = 0;
+
+  if (root_cnt > 1) {
+    // --- compute remaining top levels of merkle tree, including root ---
+    sycl::event evt = orchestrate<kernelTopLevelsReduction<N, TILE_LOG>>(
+      q, leaf_cnt, leaves, top, root_cnt >> 1, 1, 1, 0, evts);
+    evt.wait();
+
+    reduction_tm = time_event(evt);
+  } else {
+    // there's only one subtree, whose root is root of tree
+    evts[0].wait();
+  }
+
+  sycl::cl_ulong subtree_tm = 0;
+  for (size_t i = 0; i < N; i++) {
+    subtree_tm = std::max(subtree_tm, time_event(evts[i]));
+  }
+
+  return subtree_tm + reduction_tm;
+}
+
+// Transfers top K levels of binary merkle tree ( i.e. first 2^K slots, each
+// slot is 32 -bytes wide ) from `intermediates` living in device memory, to
+// `out`, which needs to have at least 2^K slots
+//
+// Works both for intermediates computed by `merklize::merklize`, because
+// top levels are kept at beginning of intermediates, and for top levels
+// computed by `merklize_top_levels`, so that instead of whole tree, just
+// O(2^K) bytes need to be transferred back to host. Transfer starts after all
+// `deps` complete.
+sycl::event
+read_top_levels(sycl::queue& q,
+                const uint32_t* const intermediates,
+                uint32_t* const out,
+                const size_t K,
+                const std::vector<sycl::event>& deps = {})
+{
+  return q.memcpy(out, intermediates, (1ul << K) << 5, deps);
+}
+
+}
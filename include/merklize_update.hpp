@@ -0,0 +1,160 @@
+#pragma once
+#include "merklize.hpp"
+#include <algorithm>
+
+namespace merklize {
+
+// Kernel predeclared to avoid name mangling in optimization report
+//
+// Note, its hash engine kernel is named after it, see
+// `engine::kernelSHA256Hash`
+class kernelUpdateOrchestrator;
+
+// Given strictly increasing indices of `dirty_cnt` -many dirty leaves of
+// binary merkle tree with `leaf_cnt` leaves, computes how many distinct
+// ancestors they have, over all log2(leaf_cnt) levels above leaves, which is
+// how many 2-to-1 hashes are required for updating them
+static inline size_t
+ancestor_cnt(const size_t leaf_cnt,
+             const size_t* const idx,
+             const size_t dirty_cnt)
+{
+  std::vector<size_t> lvl(idx, idx + dirty_cnt);
+  size_t cnt = 0;
+
+  for (size_t w = leaf_cnt >> 1; w > 0; w >>= 1) {
+    for (auto& i : lvl) {
+      i >>= 1;
+    }
+
+    lvl.erase(std::unique(lvl.begin(), lvl.end()), lvl.end());
+    cnt += lvl.size();
+  }
+
+  return cnt;
+}
+
+// Updates binary merkle tree with `leaf_cnt` leaves, whose intermediates are
+// already computed by `merklize::merklize`, after `dirty_cnt` -many leaves
+// have changed, where i-th changed leaf is at index `idx[i]` & its new value
+// is 8 words, starting at word offset (i << 3) of `digests`
+//
+// New leaves are written to `leaves`, while only intermediates on paths from
+// changed leaves to root are recomputed, in place, so cost scales with
+// dirty_cnt * log2(leaf_cnt), instead of leaf_cnt. Orchestrator kernel goes
+// level by level, collecting parents of previous level's dirty nodes, where
+// shared parents are deduplicated ( as indices are sorted, duplicates are
+// adjacent ), streaming those through hash engine, see `engine::stream`.
+//
+// `leaves` and `intermediates` must live in device memory, while `idx` (
+// strictly increasing ) and `digests` can be anywhere in host memory.
+//
+// Ensure that SYCL queue has profiling enabled, as at successful
+// completion of this routine it returns time spent in updating
+// intermediate nodes of binary merkle tree
+sycl::cl_ulong
+update(sycl::queue& q,
+       const size_t leaf_cnt,
+       uint32_t* const __restrict leaves,
+       uint32_t* const __restrict intermediates,
+       const size_t* const __restrict idx,
+       const uint32_t* const __restrict digests,
+       const size_t dirty_cnt)
+{
+  using Tag = kernelUpdateOrchestrator;
+
+  assert((leaf_cnt & (leaf_cnt - 1)) == 0); // ensure power of 2
+  assert(leaf_cnt >= 2);
+  assert(dirty_cnt > 0);
+  // ensure dirty leaves are sorted & not repeated
+  assert(std::adjacent_find(idx, idx + dirty_cnt, std::greater_equal<>()) ==
+         idx + dirty_cnt);
+  assert(idx[dirty_cnt - 1] < leaf_cnt);
+
+  const size_t list_size = dirty_cnt * sizeof(size_t);
+  const size_t digests_size = dirty_cnt << 5;
+
+  // dirty nodes of current & next level, used in turns
+  size_t* lists_d =
+    static_cast<size_t*>(sycl::malloc_device(list_size << 1, q));
+  uint32_t* digests_d =
+    static_cast<uint32_t*>(sycl::malloc_device(digests_size, q));
+
+  sycl::event evt0 = q.memcpy(lists_d, idx, list_size);
+  sycl::event evt1 = q.memcpy(digests_d, digests, digests_size);
+
+  engine::launch<Tag>(q, ancestor_cnt(leaf_cnt, idx, dirty_cnt));
+
+  sycl::event evt = q.submit([&](sycl::handler& h) {
+    h.depends_on({ evt0, evt1 });
+
+    h.single_task<Tag>([=]() {
+      sycl::device_ptr<uint32_t> leaves_ptr{ leaves };
+      sycl::device_ptr<uint32_t> intermediates_ptr{ intermediates };
+      sycl::device_ptr<uint32_t> digests_ptr{ digests_d };
+      sycl::device_ptr<size_t> src_ptr{ lists_d };
+      sycl::device_ptr<size_t> dst_ptr{ lists_d + dirty_cnt };
+
+      for (size_t i = 0; i < dirty_cnt; i++) {
+        const size_t off = src_ptr[i] << 3;
+
+#pragma unroll 8 // 256 -bit burst coalesced global memory read/ write
+        for (size_t j = 0; j < 8; j++) {
+          leaves_ptr[off + j] = digests_ptr[(i << 3) + j];
+        }
+      }
+
+      size_t cnt = dirty_cnt;
+
+      // (i+1)-th level is dependent on i-th level, while indexing is done
+      // bottom up
+      for (size_t w = leaf_cnt >> 1; w > 0; w >>= 1) {
+        // collect distinct parents of dirty nodes of level below
+        size_t dst_cnt = 0;
+        size_t last = 0;
+        for (size_t i = 0; i < cnt; i++) {
+          const size_t p = src_ptr[i] >> 1;
+
+          if (dst_cnt == 0 || last != p) {
+            dst_ptr[dst_cnt++] = p;
+            last = p;
+          }
+        }
+
+        if (w == (leaf_cnt >> 1)) {
+          engine::stream<Tag>(
+            dst_cnt,
+            [&](const size_t i) {
+              return engine::load_message(leaves_ptr, dst_ptr[i] << 4);
+            },
+            [&](const size_t i, const engine::digest_t& dig) {
+              engine::store_digest(
+                intermediates_ptr, (w + dst_ptr[i]) << 3, dig);
+            });
+        } else {
+          engine::stream<Tag>(
+            dst_cnt,
+            [&](const size_t i) {
+              return engine::load_message(intermediates_ptr,
+                                          (w + dst_ptr[i]) << 4);
+            },
+            [&](const size_t i, const engine::digest_t& dig) {
+              engine::store_digest(
+                intermediates_ptr, (w + dst_ptr[i]) << 3, dig);
+            });
+        }
+
+        std::swap(src_ptr, dst_ptr);
+        cnt = dst_cnt;
+      }
+    });
+  });
+  evt.wait();
+
+  sycl::free(lists_d, q);
+  sycl::free(digests_d, q);
+
+  return time_event(evt);
+}
+
+}
@@ -1,5 +1,7 @@
 #pragma once
 #include <CL/sycl.hpp>
+#include <array>
+#include <cassert>
 #include <sycl/ext/intel/fpga_extensions.hpp>
 
 namespace sha256 {
@@ -15,7 +17,7 @@ lt_32(const uint8_t n)
 // Circular right shift of 32 -bit sha256 word, with compile-time check
 // for rotation bit position n ( < 32 )
 template<uint8_t n>
-static inline const uint32_t
+static inline constexpr uint32_t
 rotr(const uint32_t x) requires(lt_32(n))
 {
   return (x >> n) | (x << (32 - n));
@@ -56,7 +58,7 @@ constexpr uint32_t K[64] = {
 //
 // Taken from
 // https://github.com/itzmeanjan/merklize-sha/blob/a209e74b91b5da8ce6dc360fc0b107ac9e693d12/include/sha2.hpp#L37-L45
-static inline const uint32_t
+static inline constexpr uint32_t
 ch(const uint32_t x, const uint32_t y, const uint32_t z)
 {
   return (x & y) ^ (~x & z);
@@ -67,7 +69,7 @@ ch(const uint32_t x, const uint32_t y, const uint32_t z)
 //
 // Taken from
 // https://github.com/itzmeanjan/merklize-sha/blob/a209e74b91b5da8ce6dc360fc0b107ac9e693d12/include/sha2.hpp#L47-L55
-static inline const uint32_t
+static inline constexpr uint32_t
 maj(const uint32_t x, const uint32_t y, const uint32_t z)
 {
   return (x & y) ^ (x & z) ^ (y & z);
@@ -78,7 +80,7 @@ maj(const uint32_t x, const uint32_t y, const uint32_t z)
 //
 // Taken from
 // https://github.com/itzmeanjan/merklize-sha/blob/a209e74b91b5da8ce6dc360fc0b107ac9e693d12/include/sha2.hpp#L57-L63
-static inline const uint32_t
+static inline constexpr uint32_t
 Σ_0(const uint32_t x)
 {
   return rotr<2>(x) ^ rotr<13>(x) ^ rotr<22>(x);
@@ -89,7 +91,7 @@ static inline const uint32_t
 //
 // Taken from
 // https://github.com/itzmeanjan/merklize-sha/blob/a209e74b91b5da8ce6dc360fc0b107ac9e693d12/include/sha2.hpp#L65-L71
-static inline const uint32_t
+static inline constexpr uint32_t
 Σ_1(const uint32_t x)
 {
   return rotr<6>(x) ^ rotr<11>(x) ^ rotr<25>(x);
@@ -100,7 +102,7 @@ static inline const uint32_t
 //
 // Taken from
 // https://github.com/itzmeanjan/merklize-sha/blob/a209e74b91b5da8ce6dc360fc0b107ac9e693d12/include/sha2.hpp#L73-L79
-static inline const uint32_t
+static inline constexpr uint32_t
 σ_0(const uint32_t x)
 {
   return rotr<7>(x) ^ rotr<18>(x) ^ (x >> 3);
@@ -111,7 +113,7 @@ static inline const uint32_t
 //
 // Taken from
 // https://github.com/itzmeanjan/merklize-sha/blob/a209e74b91b5da8ce6dc360fc0b107ac9e693d12/include/sha2.hpp#L81-L87
-static inline const uint32_t
+static inline constexpr uint32_t
 σ_1(const uint32_t x)
 {
   return rotr<17>(x) ^ rotr<19>(x) ^ (x >> 10);
@@ -186,6 +188,196 @@ pad_input_message(sycl::private_ptr<uint32_t> in,
   out[31] = 0u | 0b00000010u << 8;
 }
 
+// SHA256 compression engine variants, trading FPGA area for throughput
+//
+// - compact  : 64 rounds ( and message schedule preparation ) are executed
+//              by a pipelined loop, so one message block is compressed in
+//              ~64 cycles, while using area of just one round
+// - unrolled : 64 rounds ( and message schedule preparation ) are fully
+//              unrolled into a deep pipeline, so that a loop invoking it can
+//              accept new message block every clock cycle, at cost of
+//              replicating round logic 64 times
+// - rolling  : same as compact, but instead of materializing all 64 message
+//              schedules upfront, t-th one is computed on the fly, during
+//              t-th round, from a 16 -entry shift register, so that engine
+//              needs 16 words of schedule storage instead of 64
+enum class variant
+{
+  compact,
+  unrolled,
+  rolling
+};
+
+// Variant of SHA256 compression engine, chosen at compile time, to be used by
+// hash engine kernels. Compact engine is default, while compiling with
+// -DSHA256_UNROLLED or -DSHA256_ROLLING selects unrolled or rolling engine.
+#if defined SHA256_UNROLLED
+constexpr variant VARIANT = variant::unrolled;
+#elif defined SHA256_ROLLING
+constexpr variant VARIANT = variant::rolling;
+#else
+constexpr variant VARIANT = variant::compact;
+#endif
+
+// Number of message schedule words, chosen engine variant needs to keep, which
+// is how large `msg_schld` argument of `compress`, `hash` etc. must be
+static inline constexpr size_t
+schedule_words(const variant v)
+{
+  return v == variant::rolling ? 16 : 64;
+}
+
+// Applies 64 rounds on 256 -bit hash state, where `kw(t)` returns sum of t-th
+// round constant & t-th message schedule, using chosen engine variant
+//
+// See steps 2-4 of algorithm defined in section 6.2.2 of Secure Hash Standard
+// http://dx.doi.org/10.6028/NIST.FIPS.180-4
+template<variant v, typename KW>
+inline void
+apply_rounds(sycl::private_ptr<uint32_t> hash_state, KW kw)
+{
+  // step 2 of algorithm defined in section 6.2.2 of Secure Hash Standard
+  // http://dx.doi.org/10.6028/NIST.FIPS.180-4
+  uint32_t a = hash_state[0];
+  uint32_t b = hash_state[1];
+  uint32_t c = hash_state[2];
+  uint32_t d = hash_state[3];
+  uint32_t e = hash_state[4];
+  uint32_t f = hash_state[5];
+  uint32_t g = hash_state[6];
+  uint32_t h = hash_state[7];
+
+  // step 3 of algorithm defined in section 6.2.2 of Secure Hash Standard
+  // http://dx.doi.org/10.6028/NIST.FIPS.180-4
+  //
+  // for compact engine, this loop will be pipelined, but multiple iterations
+  // can't be parallelly executed, because 64 rounds are applied sequentially
+  // --- so data dependency is in play ! While for unrolled engine, each round
+  // gets its own logic, forming a 64 -stage deep pipeline
+  auto round = [&](const size_t t) {
+    const uint32_t tmp0 = h + Σ_1(e) + ch(e, f, g) + kw(t);
+    const uint32_t tmp1 = Σ_0(a) + maj(a, b, c);
+
+    h = g;
+    g = f;
+    f = e;
+    e = d + tmp0;
+    d = c;
+    c = b;
+    b = a;
+    a = tmp0 + tmp1;
+  };
+
+  if constexpr (v == variant::unrolled) {
+#pragma unroll
+    for (size_t t = 0; t < 64; t++) {
+      round(t);
+    }
+  } else {
+    for (size_t t = 0; t < 64; t++) {
+      round(t);
+    }
+  }
+
+  // see step 4 of algorithm defined in section  6.2.2 of Secure Hash Standard
+  // http://dx.doi.org/10.6028/NIST.FIPS.180-4
+  hash_state[0] += a;
+  hash_state[1] += b;
+  hash_state[2] += c;
+  hash_state[3] += d;
+  hash_state[4] += e;
+  hash_state[5] += f;
+  hash_state[6] += g;
+  hash_state[7] += h;
+}
+
+// Mixes 512 -bit message block into 256 -bit hash state, by preparing 64
+// message schedules and applying 64 rounds, using chosen engine variant
+//
+// See steps 1-4 of algorithm defined in section 6.2.2 of Secure Hash Standard
+// http://dx.doi.org/10.6028/NIST.FIPS.180-4
+template<variant v>
+inline void
+compress(sycl::private_ptr<uint32_t> hash_state,
+         sycl::private_ptr<uint32_t> msg_schld,
+         sycl::private_ptr<uint32_t> in)
+{
+  // step 1 of algorithm defined in section 6.2.2 of Secure Hash Standard
+  // http://dx.doi.org/10.6028/NIST.FIPS.180-4
+  if constexpr (v == variant::unrolled) {
+#pragma unroll
+    for (size_t i = 0; i < 16; i++) {
+      msg_schld[i] = in[i];
+    }
+
+#pragma unroll
+    for (size_t i = 16; i < 64; i++) {
+      const uint32_t tmp0 = σ_1(msg_schld[i - 2]) + msg_schld[i - 7];
+      const uint32_t tmp1 = σ_0(msg_schld[i - 15]) + msg_schld[i - 16];
+
+      msg_schld[i] = tmp0 + tmp1;
+    }
+  } else if constexpr (v == variant::rolling) {
+#pragma unroll 16 // 512 -bit burst coalesced loading
+    for (size_t i = 0; i < 16; i++) {
+      msg_schld[i] = in[i];
+    }
+  } else {
+    prepare_message_schedule(in, msg_schld);
+  }
+
+  // steps 2-4 of algorithm defined in section 6.2.2 of Secure Hash Standard
+  // http://dx.doi.org/10.6028/NIST.FIPS.180-4
+  if constexpr (v == variant::rolling) {
+    // during t-th round, shift register holds message schedules W[t..t+16),
+    // so W[t] is consumed from its head, while W[t+16] is computed & pushed
+    // at its tail
+    apply_rounds<v>(hash_state, [&](const size_t t) {
+      const uint32_t w = msg_schld[0];
+      const uint32_t tmp0 = σ_1(msg_schld[14]) + msg_schld[9];
+      const uint32_t tmp1 = σ_0(msg_schld[1]) + w;
+
+#pragma unroll 15
+      for (size_t i = 0; i < 15; i++) {
+        msg_schld[i] = msg_schld[i + 1];
+      }
+      msg_schld[15] = tmp0 + tmp1;
+
+      return K[t] + w;
+    });
+  } else {
+    apply_rounds<v>(hash_state, [&](const size_t t) {
+      return K[t] + msg_schld[t];
+    });
+  }
+}
+
+// Computes message schedule of the constant second block of padded input of
+// 2-to-1 hash ( see `pad_input_message` ) at compile time, with t-th round
+// constant already added to t-th message schedule
+static inline constexpr std::array<uint32_t, 64>
+compute_kw_pad()
+{
+  std::array<uint32_t, 64> w{};
+
+  w[0] = 0b10000000u << 24;
+  w[15] = 0u | 0b00000010u << 8;
+
+  for (size_t i = 16; i < 64; i++) {
+    w[i] = σ_1(w[i - 2]) + w[i - 7] + σ_0(w[i - 15]) + w[i - 16];
+  }
+
+  for (size_t i = 0; i < 64; i++) {
+    w[i] += K[i];
+  }
+
+  return w;
+}
+
+// K[t] + W[t], for t = 0..63, where W is message schedule of the constant
+// padding block, which is always the second block of 2-to-1 hash input
+constexpr std::array<uint32_t, 64> KW_PAD = compute_kw_pad();
+
 // As input takes two padded, parsed input message blocks ( = 1024 -bit, total )
 // and computes SHA2-256 digest ( = 256 -bit ) in two sequential rounds
 //
@@ -193,6 +385,7 @@ pad_input_message(sycl::private_ptr<uint32_t> in,
 //
 // See algorithm defined in section 6.2.2 of Secure Hash Standard
 // http://dx.doi.org/10.6028/NIST.FIPS.180-4
+template<variant v = variant::compact>
 void
 hash(sycl::private_ptr<uint32_t> hash_state,
      sycl::private_ptr<uint32_t> msg_schld,
@@ -207,58 +400,223 @@ hash(sycl::private_ptr<uint32_t> hash_state,
   // padded input message is 1024 -bit wide, so two message blocks ( each of 512
   // -bit ) are to be mixed into hash state in two sequential rounds
   //
-  // this loop will be pipelined, but mutliple iterations can't be parallelly
-  // executed, due to sequential data dependency
-  for (size_t i = 0; i < 2; i++) {
-    // step 1 of algorithm defined in section 6.2.2 of Secure Hash Standard
-    // http://dx.doi.org/10.6028/NIST.FIPS.180-4
-    prepare_message_schedule(in + (i << 4), msg_schld);
-
-    // step 2 of algorithm defined in section 6.2.2 of Secure Hash Standard
-    // http://dx.doi.org/10.6028/NIST.FIPS.180-4
-    uint32_t a = hash_state[0];
-    uint32_t b = hash_state[1];
-    uint32_t c = hash_state[2];
-    uint32_t d = hash_state[3];
-    uint32_t e = hash_state[4];
-    uint32_t f = hash_state[5];
-    uint32_t g = hash_state[6];
-    uint32_t h = hash_state[7];
-
-    // step 1 of algorithm defined in section 6.2.2 of Secure Hash Standard
-    // http://dx.doi.org/10.6028/NIST.FIPS.180-4
-    //
-    // this inner loop will be pipelined, but multiple iterations can't be
-    // parallelly executed, because 64 rounds are applied sequentially --- so
-    // data dependency is in play !
-    for (size_t t = 0; t < 64; t++) {
-      const uint32_t tmp0 = h + Σ_1(e) + ch(e, f, g) + K[t] + msg_schld[t];
-      const uint32_t tmp1 = Σ_0(a) + maj(a, b, c);
-
-      h = g;
-      g = f;
-      f = e;
-      e = d + tmp0;
-      d = c;
-      c = b;
-      b = a;
-      a = tmp0 + tmp1;
+  // for compact engine, this loop will be pipelined, but mutliple iterations
+  // can't be parallelly executed, due to sequential data dependency, while
+  // unrolled engine chains two 64 -stage deep pipelines
+  if constexpr (v == variant::unrolled) {
+#pragma unroll
+    for (size_t i = 0; i < 2; i++) {
+      compress<v>(hash_state, msg_schld, in + (i << 4));
+    }
+  } else {
+    for (size_t i = 0; i < 2; i++) {
+      compress<v>(hash_state, msg_schld, in + (i << 4));
     }
-
-    // see step 4 of algorithm defined in section  6.2.2 of Secure Hash Standard
-    // http://dx.doi.org/10.6028/NIST.FIPS.180-4
-    hash_state[0] += a;
-    hash_state[1] += b;
-    hash_state[2] += c;
-    hash_state[3] += d;
-    hash_state[4] += e;
-    hash_state[5] += f;
-    hash_state[6] += g;
-    hash_state[7] += h;
   }
 
   // now 2-to-1 digest of originally 512 -bit input should be placed on first 8
   // words of hash state
 }
 
+// Specialized SHA2-256 2-to-1 hash, taking 512 -bit unpadded input message (
+// = 16 words ) and computing 256 -bit digest, placed on hash state
+//
+// Second block of padded input is always same ( see `pad_input_message` ), so
+// instead of preparing its message schedule, precomputed `KW_PAD` is used,
+// saving one message schedule preparation & one adder per round, while input
+// also doesn't need to be padded into 32 words
+template<variant v = variant::compact>
+void
+hash_2_to_1(sycl::private_ptr<uint32_t> hash_state,
+            sycl::private_ptr<uint32_t> msg_schld,
+            sycl::private_ptr<uint32_t> in)
+{
+  // initial hash state of 256 -bit
+#pragma unroll 8 // 256 -bit burst coalesced access
+  for (size_t i = 0; i < 8; i++) {
+    hash_state[i] = IV[i];
+  }
+
+  compress<v>(hash_state, msg_schld, in);
+  apply_rounds<v>(hash_state, [](const size_t t) { return KW_PAD[t]; });
+}
+
+// Pads short message of `len` ( <= 55 ) bytes into single 512 -bit message
+// block ( = 16 words ), as 55 bytes of message, 1 byte having leading 1 -bit &
+// 8 bytes of message length fit in one block
+//
+// See section 5.1.1 of Secure Hash Standard
+// http://dx.doi.org/10.6028/NIST.FIPS.180-4
+template<typename Ptr>
+inline void
+pad_short_message(Ptr in, const size_t len, sycl::private_ptr<uint32_t> out)
+{
+  assert(len <= 55); // ensure length field doesn't overlap message
+
+#pragma unroll 16
+  for (size_t i = 0; i < 16; i++) {
+    out[i] = 0u;
+  }
+
+  for (size_t i = 0; i < len; i++) {
+    out[i >> 2] |= static_cast<uint32_t>(in[i]) << ((3 - (i & 3)) << 3);
+  }
+
+  out[len >> 2] |= 0b10000000u << ((3 - (len & 3)) << 3);
+  out[15] = static_cast<uint32_t>(len << 3);
+}
+
+// Same as above, but for short message of compile time known length `len` (
+// <= 52 ) bytes, which is already parsed into (len >> 2) words, such as 32
+// -bytes digest, so that padding is just fixed wiring
+template<size_t len>
+inline void
+pad_short_message(sycl::private_ptr<uint32_t> in,
+                  sycl::private_ptr<uint32_t> out) requires((len & 3) == 0 &&
+                                                            len <= 52)
+{
+  constexpr size_t words = len >> 2;
+
+#pragma unroll
+  for (size_t i = 0; i < words; i++) {
+    out[i] = in[i];
+  }
+
+#pragma unroll
+  for (size_t i = words; i < 16; i++) {
+    out[i] = 0u;
+  }
+
+  out[words] = 0b10000000u << 24;
+  out[15] = static_cast<uint32_t>(len << 3);
+}
+
+// Computes SHA2-256 digest of short message, already padded into single 512
+// -bit message block ( see `pad_short_message` ), using just one compression,
+// instead of two compressions `hash` requires for 64 -bytes input
+//
+// Finally computed digest is placed on first 8 words of hash state
+template<variant v = variant::compact>
+void
+hash_single_block(sycl::private_ptr<uint32_t> hash_state,
+                  sycl::private_ptr<uint32_t> msg_schld,
+                  sycl::private_ptr<uint32_t> in)
+{
+  // initial hash state of 256 -bit
+#pragma unroll 8 // 256 -bit burst coalesced access
+  for (size_t i = 0; i < 8; i++) {
+    hash_state[i] = IV[i];
+  }
+
+  compress<v>(hash_state, msg_schld, in);
+}
+
+// Streaming SHA2-256 context, which can digest arbitrary length byte message,
+// supplied in any number of chunks, using init -> update* -> final flow
+//
+// It neither allocates dynamically nor recurses, so it can be used from both
+// single_task and ND-range kernels, as a private variable. Input bytes can be
+// read from any address space, as pointer type is templated.
+//
+// See section 5.1.1 ( padding ) and 6.2 ( hash computation ) of Secure Hash
+// Standard http://dx.doi.org/10.6028/NIST.FIPS.180-4
+template<variant v = variant::compact>
+struct context
+{
+  uint32_t hash_state[8];
+  uint32_t msg_schld[schedule_words(v)];
+
+  // partially filled 64 -bytes message block, waiting to be compressed
+  uint8_t block[64];
+  size_t blk_len;
+
+  // total number of message bytes consumed so far
+  uint64_t msg_len;
+
+  // Prepares context for digesting a new message
+  inline void init()
+  {
+#pragma unroll 8
+    for (size_t i = 0; i < 8; i++) {
+      hash_state[i] = IV[i];
+    }
+
+    blk_len = 0;
+    msg_len = 0;
+  }
+
+  // Consumes next `len` -many bytes of message, compressing each message
+  // block as soon as it's filled up
+  template<typename Ptr>
+  inline void update(Ptr in, const size_t len)
+  {
+    for (size_t i = 0; i < len; i++) {
+      block[blk_len++] = in[i];
+
+      if (blk_len == 64) {
+        compress_block();
+      }
+    }
+
+    msg_len += len;
+  }
+
+  // Pads consumed message, compresses last one or two message blocks and
+  // writes 256 -bit digest ( = 8 words ) to `digest`
+  //
+  // Context needs to be initialized again, before digesting another message
+  template<typename Ptr>
+  inline void final(Ptr digest)
+  {
+    const uint64_t bit_len = msg_len << 3;
+
+    block[blk_len++] = 0b10000000u;
+
+    // not enough space left for 64 -bit message length, so one more message
+    // block is required
+    if (blk_len > 56) {
+      while (blk_len < 64) {
+        block[blk_len++] = 0u;
+      }
+      compress_block();
+    }
+
+    while (blk_len < 56) {
+      block[blk_len++] = 0u;
+    }
+
+    // message length in bits, as 64 -bit big endian integer
+#pragma unroll 8
+    for (size_t i = 0; i < 8; i++) {
+      block[56 + i] = static_cast<uint8_t>(bit_len >> ((7 - i) << 3));
+    }
+    blk_len = 64;
+
+    compress_block();
+
+#pragma unroll 8
+    for (size_t i = 0; i < 8; i++) {
+      digest[i] = hash_state[i];
+    }
+  }
+
+  // Interprets filled up 64 -bytes message block as 16 big endian words and
+  // mixes them into hash state
+  inline void compress_block()
+  {
+    uint32_t words[16];
+
+#pragma unroll 16
+    for (size_t i = 0; i < 16; i++) {
+      words[i] = (static_cast<uint32_t>(block[(i << 2) + 0]) << 24) |
+                 (static_cast<uint32_t>(block[(i << 2) + 1]) << 16) |
+                 (static_cast<uint32_t>(block[(i << 2) + 2]) << 8) |
+                 (static_cast<uint32_t>(block[(i << 2) + 3]) << 0);
+    }
+
+    compress<v>(hash_state, msg_schld, words);
+    blk_len = 0;
+  }
+};
+
 }
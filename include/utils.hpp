@@ -1,5 +1,8 @@
 #pragma once
 #include <CL/sycl.hpp>
+#include <algorithm>
+#include <limits>
+#include <vector>
 
 // Given four contiguous big endian bytes, this routine interprets those as 32
 // -bit unsigned integer
@@ -37,3 +40,25 @@ time_event(sycl::event evt)
 
   return end - start;
 }
+
+// Time span ( in nanosecond level granularity ) from start of earliest to end
+// of latest command, whose submissions resulted into supplied events, which is
+// what it takes to execute all of them, when they run concurrently
+//
+// Note, ensure that profiling is enabled on SYCL queue !
+static inline const sycl::cl_ulong
+time_events(const std::vector<sycl::event>& evts)
+{
+  sycl::cl_ulong start = std::numeric_limits<sycl::cl_ulong>::max();
+  sycl::cl_ulong end = 0;
+
+  for (auto& evt : evts) {
+    start = std::min(
+      start,
+      evt.get_profiling_info<sycl::info::event_profiling::command_start>());
+    end = std::max(
+      end, evt.get_profiling_info<sycl::info::event_profiling::command_end>());
+  }
+
+  return end - start;
+}
@@ -1,4 +1,9 @@
 #include "sha256.hpp"
+#include "test_context.hpp"
+#include "test_coro.hpp"
+#include "test_hash_batch.hpp"
+#include "test_merklize.hpp"
+#include "test_sha256.hpp"
 #include "utils.hpp"
 #include <cassert>
 #include <iostream>
@@ -22,7 +27,7 @@ main(int argc, char** argv)
 
   sycl::device d{ s };
   sycl::context c{ d };
-  sycl::queue q{ c, d };
+  sycl::queue q{ c, d, sycl::property::queue::enable_profiling{} };
 
   std::cout << "running on " << d.get_info<sycl::info::device::name>()
             << std::endl;
@@ -120,5 +125,41 @@ main(int argc, char** argv)
   sycl::free(res_d, q);
   std::free(res_h);
 
+  test_sha256_variant<sha256::variant::compact>(q);
+  test_sha256_variant<sha256::variant::unrolled>(q);
+  test_sha256_variant<sha256::variant::rolling>(q);
+
+  std::cout << "passed SHA256 compression engine variants test !"
+            << std::endl;
+
+  test_sha256_streaming(q);
+
+  std::cout << "passed streaming SHA256 test !" << std::endl;
+
+  test_sha256_single_block(q);
+
+  std::cout << "passed single block SHA256 test !" << std::endl;
+
+  test_merklize(q);
+  test_merklize_async(q);
+  test_context(q);
+  test_merklize_zero_copy(q);
+  test_merklize_inplace(q);
+  test_merklize_top_levels(q);
+  test_merklize_out_of_core(q);
+  test_merklize_update(q);
+  test_merklize_proofs(q);
+  test_verify_proofs(q);
+  test_merklize_multiproof(q);
+  test_merklize_range_proof(q);
+  test_merklize_systolic(q);
+  test_merklize_streamed(q);
+  test_merklize_rfc6962(q);
+  test_merklize_sha256d(q);
+  test_hash_batch(q);
+  test_hash_batch_chained(q);
+  test_hash_batch_32(q);
+  test_coro(q);
+
   return EXIT_SUCCESS;
 }
@@ -0,0 +1,66 @@
+#pragma once
+#include "context.hpp"
+#include "test_merklize.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+// Asserts that merklization context computes expected intermediates, from
+// pinned & pageable host memory, while reusing pooled allocations across calls,
+// so that no allocation is made once steady-state is reached
+void
+test_context(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  merklize_test_tree<2>(q, expected);
+
+  {
+    merklize::context ctx{ q };
+
+    // buffers of same size class are reused
+    uint32_t* ptr0 = ctx.acquire_device(100);
+    ctx.release(ptr0);
+    uint32_t* ptr1 = ctx.acquire_device(128);
+    ctx.release(ptr1);
+
+    assert(ptr0 == ptr1);
+    assert(ctx.alloc_cnt() == 1);
+
+    uint32_t* leaves = ctx.acquire_host(size);
+    uint32_t* intermediates = ctx.acquire_host(size);
+    sycl::cl_ulong ts[3];
+
+    prepare_test_leaves(leaves, TEST_LEAF_CNT);
+
+    ctx.merklize<2>(TEST_LEAF_CNT, leaves, intermediates, ts);
+    assert(std::memcmp(expected + 8, intermediates + 8, size - 32) == 0);
+
+    const size_t alloc_cnt = ctx.alloc_cnt();
+
+    ctx.merklize<2>(TEST_LEAF_CNT, leaves, intermediates, ts);
+    assert(std::memcmp(expected + 8, intermediates + 8, size - 32) == 0);
+    assert(ctx.alloc_cnt() == alloc_cnt);
+
+    // pageable memory is staged through pooled pinned buffers
+    uint32_t* leaves_p = static_cast<uint32_t*>(std::malloc(size));
+    uint32_t* intermediates_p = static_cast<uint32_t*>(std::malloc(size));
+
+    prepare_test_leaves(leaves_p, TEST_LEAF_CNT);
+
+    ctx.release(leaves);
+    ctx.release(intermediates);
+
+    ctx.merklize<2>(TEST_LEAF_CNT, leaves_p, intermediates_p, ts);
+    assert(std::memcmp(expected + 8, intermediates_p + 8, size - 32) == 0);
+    assert(ctx.alloc_cnt() == alloc_cnt);
+
+    std::free(leaves_p);
+    std::free(intermediates_p);
+  }
+
+  std::free(expected);
+
+  std::cout << "passed merklization context test !" << std::endl;
+}
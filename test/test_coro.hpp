@@ -0,0 +1,146 @@
+#pragma once
+#include "coro.hpp"
+#include "hash_batch.hpp"
+#include "test_merklize.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+// Computes test binary merkle tree on device, suspending on each enqueued
+// command, where merklization is chained after that of other jobs, while
+// finally checking whether computed root is as expected, see `TEST_ROOT`
+coro::task<bool>
+merklize_job(coro::executor& ex, sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* root_h = static_cast<uint32_t*>(std::malloc(32));
+  uint32_t* leaves_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+
+  co_await ex.wait(q.memcpy(leaves_d, leaves_h, size));
+  co_await ex.submit<merklize::kernelMerklizationReduction<4>>(
+    [&](const std::vector<sycl::event>& deps) {
+      return merklize::merklize_async<4>(
+        q, TEST_LEAF_CNT, leaves_d, size, intermediates_d, size, deps);
+    });
+  co_await ex.wait(q.memcpy(root_h, intermediates_d + 8, 32));
+
+  const bool ok = std::memcmp(root_h, TEST_ROOT, 32) == 0;
+
+  sycl::free(leaves_d, q);
+  sycl::free(intermediates_d, q);
+  std::free(leaves_h);
+  std::free(root_h);
+
+  co_return ok;
+}
+
+// Computes root of test binary merkle tree by batched hashing of each level,
+// suspending on each of them, where batches are chained after those of other
+// jobs, while finally checking whether computed root is as expected, see
+// `TEST_ROOT`
+coro::task<bool>
+hash_batch_job(coro::executor& ex, sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* root_h = static_cast<uint32_t*>(std::malloc(32));
+  uint32_t* bufs[2] = {
+    static_cast<uint32_t*>(sycl::malloc_device(size, q)),
+    static_cast<uint32_t*>(sycl::malloc_device(size, q)),
+  };
+
+  prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+
+  co_await ex.wait(q.memcpy(bufs[0], leaves_h, size));
+
+  size_t lvl = 0;
+  for (size_t w = TEST_LEAF_CNT >> 1; w > 0; w >>= 1, lvl ^= 1) {
+    co_await ex.submit<sha256::kernelSHA256BatchOrchestrator<64>>(
+      [&](const std::vector<sycl::event>& deps) {
+        return sha256::hash_batch(q, bufs[lvl], bufs[lvl ^ 1], w, deps);
+      });
+  }
+
+  co_await ex.wait(q.memcpy(root_h, bufs[lvl], 32));
+
+  const bool ok = std::memcmp(root_h, TEST_ROOT, 32) == 0;
+
+  sycl::free(bufs[0], q);
+  sycl::free(bufs[1], q);
+  std::free(leaves_h);
+  std::free(root_h);
+
+  co_return ok;
+}
+
+// Awaits both of above jobs, one after another, counting how many of them
+// computed expected root
+coro::task<size_t>
+sequential_jobs(coro::executor& ex, sycl::queue& q)
+{
+  size_t cnt = 0;
+
+  cnt += co_await merklize_job(ex, q);
+  cnt += co_await hash_batch_job(ex, q);
+
+  co_return cnt;
+}
+
+// Asserts that coroutines, suspended on SYCL events, are driven to completion
+// by single threaded executor, both when they're spawned concurrently ( two
+// jobs of each kind, sharing same kernels ) and when one of them awaits others,
+// while commands of same family are chained, irrespective of call site
+void
+test_coro(sycl::queue& q)
+{
+  coro::executor ex;
+
+  coro::task<bool> t0 = merklize_job(ex, q);
+  coro::task<bool> t1 = merklize_job(ex, q);
+  coro::task<bool> t2 = hash_batch_job(ex, q);
+  coro::task<bool> t3 = hash_batch_job(ex, q);
+
+  ex.spawn(t0);
+  ex.spawn(t1);
+  ex.spawn(t2);
+  ex.spawn(t3);
+  ex.run();
+
+  assert(t0.done() && t0.get());
+  assert(t1.done() && t1.get());
+  assert(t2.done() && t2.get());
+  assert(t3.done() && t3.get());
+
+  coro::task<size_t> t4 = sequential_jobs(ex, q);
+
+  ex.spawn(t4);
+  ex.run();
+
+  assert(t4.done() && t4.get() == 2);
+
+  // same family, submitted from two distinct call sites, must still be chained
+  coro::executor ex1;
+  size_t dep_cnt[2] = {};
+
+  using Family = merklize::kernelMerklizationReduction<4>;
+
+  ex1.submit<Family>([&](const std::vector<sycl::event>& deps) {
+    dep_cnt[0] = deps.size();
+    return sycl::event{};
+  });
+  ex1.submit<Family>([&](const std::vector<sycl::event>& deps) {
+    dep_cnt[1] = deps.size();
+    return sycl::event{};
+  });
+
+  assert(dep_cnt[0] == 0 && dep_cnt[1] == 1);
+
+  std::cout << "passed coroutine front-end test !" << std::endl;
+}
@@ -0,0 +1,117 @@
+#pragma once
+#include "hash_batch.hpp"
+#include "test_merklize.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+// Asserts that batched hashing of independent 64 -bytes messages produces
+// same digests as lowest level of intermediates, computed by binary
+// merklization, when messages are leaf pairs of test binary merkle tree
+void
+test_hash_batch(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+  const size_t msg_cnt = TEST_LEAF_CNT >> 1;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* in_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* out_d = static_cast<uint32_t*>(sycl::malloc_device(size >> 1, q));
+
+  merklize_test_tree<1>(q, expected);
+
+  prepare_test_leaves(computed, TEST_LEAF_CNT);
+  q.memcpy(in_d, computed, size).wait();
+
+  sycl::event evt = sha256::hash_batch(q, in_d, out_d, msg_cnt);
+  q.memcpy(computed, out_d, size >> 1, evt).wait();
+
+  assert(std::memcmp(computed, expected + (msg_cnt << 3), size >> 1) == 0);
+
+  sycl::free(in_d, q);
+  sycl::free(out_d, q);
+  std::free(expected);
+  std::free(computed);
+
+  std::cout << "passed batched SHA256 hashing test !" << std::endl;
+}
+
+// Asserts that two batches, enqueued back to back, where second one hashes
+// digests produced by first one, produce same digests as two lowest levels of
+// intermediates, computed by binary merklization
+void
+test_hash_batch_chained(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+  const size_t msg_cnt = TEST_LEAF_CNT >> 1;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* in_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* mid_d = static_cast<uint32_t*>(sycl::malloc_device(size >> 1, q));
+  uint32_t* out_d = static_cast<uint32_t*>(sycl::malloc_device(size >> 2, q));
+
+  merklize_test_tree<1>(q, expected);
+
+  prepare_test_leaves(computed, TEST_LEAF_CNT);
+  q.memcpy(in_d, computed, size).wait();
+
+  sycl::event evt0 = sha256::hash_batch(q, in_d, mid_d, msg_cnt);
+  sycl::event evt1 =
+    sha256::hash_batch(q, mid_d, out_d, msg_cnt >> 1, { evt0 });
+  q.memcpy(computed, out_d, size >> 2, evt1).wait();
+
+  assert(std::memcmp(computed, expected + (msg_cnt << 2), size >> 2) == 0);
+
+  sycl::free(in_d, q);
+  sycl::free(mid_d, q);
+  sycl::free(out_d, q);
+  std::free(expected);
+  std::free(computed);
+
+  std::cout << "passed chained batched SHA256 hashing test !" << std::endl;
+}
+
+// Asserts that batched hashing of independent 32 -bytes messages, each hashed
+// with single compression, produces expected digests, when messages are
+// leaves of test binary merkle tree, where digests of first and last leaves
+// are
+//
+// $ python3
+// >>> import hashlib, struct
+// >>> ls = [struct.pack('>8I', *range(i * 8, i * 8 + 8)) for i in range(1024)]
+// >>> struct.unpack('>8I', hashlib.sha256(ls[0]).digest())
+// >>> struct.unpack('>8I', hashlib.sha256(ls[1023]).digest())
+void
+test_hash_batch_32(sycl::queue& q)
+{
+  constexpr uint32_t first[8] = { 0xbdb32f86u, 0x04eafe89u, 0xad767fe7u,
+                                  0xfe8ccd29u, 0xecc5d0deu, 0x9b7a3c9du,
+                                  0x95e3ccedu, 0x553d625au };
+  constexpr uint32_t last[8] = { 0xfe908b1bu, 0xcbd50365u, 0x743e8506u,
+                                 0xbb240846u, 0xb947d1b0u, 0x6d464b23u,
+                                 0x48406f9du, 0x3e4b2f88u };
+
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* leaves = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* in_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* out_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  prepare_test_leaves(leaves, TEST_LEAF_CNT);
+  q.memcpy(in_d, leaves, size).wait();
+
+  sycl::event evt = sha256::hash_batch<32>(q, in_d, out_d, TEST_LEAF_CNT);
+  q.memcpy(leaves, out_d, size, evt).wait();
+
+  assert(std::memcmp(leaves, first, sizeof(first)) == 0);
+  assert(std::memcmp(leaves + (size >> 2) - 8, last, sizeof(last)) == 0);
+
+  sycl::free(in_d, q);
+  sycl::free(out_d, q);
+  std::free(leaves);
+
+  std::cout << "passed batched SHA256 hashing of 32 -bytes messages test !"
+            << std::endl;
+}
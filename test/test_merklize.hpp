@@ -0,0 +1,925 @@
+#pragma once
+#include "merklize.hpp"
+#include "merklize_compact.hpp"
+#include "merklize_inplace.hpp"
+#include "merklize_ooc.hpp"
+#include "merklize_proof.hpp"
+#include "merklize_range.hpp"
+#include "merklize_streamed.hpp"
+#include "merklize_systolic.hpp"
+#include "merklize_top.hpp"
+#include "merklize_update.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+// Leaf count of binary merkle tree, used for functional correctness check of
+// merklization routines
+constexpr size_t TEST_LEAF_CNT = 1ul << 10;
+
+// Expected root of binary merkle tree with `TEST_LEAF_CNT` leaves, where i-th
+// word of leaves is i
+//
+// $ python3
+// >>> import hashlib, struct
+// >>> ls = [struct.pack('>8I', *range(i * 8, i * 8 + 8)) for i in range(1024)]
+// >>> while len(ls) > 1:
+// ...   ls = [hashlib.sha256(ls[i] + ls[i + 1]).digest()
+// ...         for i in range(0, len(ls), 2)]
+// >>> struct.unpack('>8I', ls[0])
+constexpr uint32_t TEST_ROOT[8] = { 0x6b015491u, 0x24bbd6c9u, 0xa9c92f60u,
+                                    0x060aab9eu, 0x2efc0d6bu, 0x33c35778u,
+                                    0xab27ee52u, 0x82296564u };
+
+// Prepares leaves of test binary merkle tree on host, see `TEST_ROOT`
+static inline void
+prepare_test_leaves(uint32_t* const leaves, const size_t leaf_cnt)
+{
+  for (size_t i = 0; i < (leaf_cnt << 3); i++) {
+    leaves[i] = static_cast<uint32_t>(i);
+  }
+}
+
+// Computes all intermediates of test binary merkle tree using N subtrees (
+// each computed in tiles of 2^TILE_LOG leaves, if TILE_LOG is non-zero ), and
+// copies them back to `intermediates` ( allocated on host )
+template<size_t N, size_t TILE_LOG = 0>
+void
+merklize_test_tree(sycl::queue& q, uint32_t* const intermediates)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* leaves_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+
+  q.memcpy(leaves_d, leaves_h, size).wait();
+  q.memset(intermediates_d, 0, size).wait();
+
+  merklize::merklize<N, TILE_LOG>(
+    q, TEST_LEAF_CNT, leaves_d, size, intermediates_d, size);
+
+  q.memcpy(intermediates, intermediates_d, size).wait();
+
+  sycl::free(leaves_d, q);
+  sycl::free(intermediates_d, q);
+  std::free(leaves_h);
+}
+
+// Test binary merkle tree, resident in device memory, for routines working on
+// already merklized tree, such as incremental update & proof extraction, while
+// its leaves & intermediates are also kept on host, for checking results
+//
+// Device & host allocations are freed when fixture goes out of scope
+struct resident_test_tree
+{
+  sycl::queue& q;
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* const leaves_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* const intermediates_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* const leaves_d =
+    static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* const intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  explicit resident_test_tree(sycl::queue& q)
+    : q(q)
+  {
+    prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+    rebuild();
+  }
+
+  resident_test_tree(const resident_test_tree&) = delete;
+  resident_test_tree& operator=(const resident_test_tree&) = delete;
+
+  ~resident_test_tree()
+  {
+    sycl::free(leaves_d, q);
+    sycl::free(intermediates_d, q);
+    std::free(leaves_h);
+    std::free(intermediates_h);
+  }
+
+  // Copies leaves from host to device & merklizes them from scratch, copying
+  // computed intermediates back to host
+  void rebuild()
+  {
+    q.memcpy(leaves_d, leaves_h, size).wait();
+    merklize::merklize<1>(
+      q, TEST_LEAF_CNT, leaves_d, size, intermediates_d, size);
+    q.memcpy(intermediates_h, intermediates_d, size).wait();
+  }
+};
+
+// Asserts that binary merklization produces bit-identical intermediates,
+// irrespective of how many subtrees tree is split into & whether subtrees are
+// computed in on-chip tiles or not, with expected root
+void
+test_merklize(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+
+  merklize_test_tree<1>(q, expected);
+  assert(std::memcmp(expected + 8, TEST_ROOT, sizeof(TEST_ROOT)) == 0);
+
+  merklize_test_tree<2>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  merklize_test_tree<4>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  merklize_test_tree<8>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  merklize_test_tree<1, 4>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  merklize_test_tree<4, 2>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  // each subtree is exactly one tile
+  merklize_test_tree<2, 9>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  std::free(expected);
+  std::free(computed);
+
+  std::cout << "passed binary merklization test !" << std::endl;
+}
+
+// Asserts that asynchronous merklization, chained in between transfer of
+// leaves to device & transfer of intermediates back to host, for two trees
+// enqueued back to back, without any host synchronization, produces same
+// intermediates, as blocking `merklize::merklize` does
+void
+test_merklize_async(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed[2];
+  uint32_t* leaves_d[2];
+  uint32_t* intermediates_d[2];
+
+  for (size_t i = 0; i < 2; i++) {
+    computed[i] = static_cast<uint32_t*>(std::malloc(size));
+    leaves_d[i] = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+    intermediates_d[i] = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  }
+
+  merklize_test_tree<2>(q, expected);
+  prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+
+  std::vector<sycl::event> evts[2];
+  sycl::event done[2];
+  sycl::event prev;
+
+  for (size_t i = 0; i < 2; i++) {
+    std::vector<sycl::event> deps{ q.memcpy(leaves_d[i], leaves_h, size) };
+    if (i > 0) {
+      deps.push_back(prev); // kernels are shared by both trees
+    }
+
+    prev = merklize::merklize_async<2>(q,
+                                       TEST_LEAF_CNT,
+                                       leaves_d[i],
+                                       size,
+                                       intermediates_d[i],
+                                       size,
+                                       deps,
+                                       &evts[i]);
+    done[i] = q.memcpy(computed[i], intermediates_d[i], size, prev);
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    done[i].wait();
+
+    assert(evts[i].size() == 3);
+    assert(merklize::exec_time<2>(evts[i]) > 0);
+    assert(std::memcmp(expected + 8, computed[i] + 8, size - 32) == 0);
+  }
+
+  for (size_t i = 0; i < 2; i++) {
+    sycl::free(leaves_d[i], q);
+    sycl::free(intermediates_d[i], q);
+    std::free(computed[i]);
+  }
+  std::free(expected);
+  std::free(leaves_h);
+
+  std::cout << "passed asynchronous binary merklization test !" << std::endl;
+}
+
+// Asserts that merklization, while kernels read leaves directly from host (
+// or shared ) USM allocation, produces same intermediates, as
+// `merklize::merklize` does, when leaves are in device memory
+void
+test_merklize_zero_copy(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* leaves[2] = {
+    static_cast<uint32_t*>(sycl::malloc_host(size, q)),
+    static_cast<uint32_t*>(sycl::malloc_shared(size, q)),
+  };
+  uint32_t* intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  merklize_test_tree<2>(q, expected);
+
+  for (size_t i = 0; i < 2; i++) {
+    prepare_test_leaves(leaves[i], TEST_LEAF_CNT);
+    q.memset(intermediates_d, 0, size).wait();
+
+    merklize::merklize<2, 0, true>(
+      q, TEST_LEAF_CNT, leaves[i], size, intermediates_d, size);
+
+    q.memcpy(computed, intermediates_d, size).wait();
+    assert(std::memcmp(expected, computed, size) == 0);
+  }
+
+  sycl::free(leaves[0], q);
+  sycl::free(leaves[1], q);
+  sycl::free(intermediates_d, q);
+  std::free(expected);
+  std::free(computed);
+
+  std::cout << "passed zero-copy binary merklization test !" << std::endl;
+}
+
+// Computes all intermediates of test binary merkle tree in-place, using N
+// subtrees, and asserts that each of them, found following in-place layout,
+// is same as corresponding intermediate in `expected`, computed by
+// `merklize::merklize`
+template<size_t N>
+void
+check_merklize_inplace(sycl::queue& q, const uint32_t* const expected)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* buf_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  prepare_test_leaves(computed, TEST_LEAF_CNT);
+  q.memcpy(buf_d, computed, size).wait();
+
+  merklize::merklize_inplace<N>(q, TEST_LEAF_CNT, buf_d, size);
+
+  q.memcpy(computed, buf_d, size).wait();
+
+  const merklize::inplace_layout layout{ TEST_LEAF_CNT, N };
+
+  assert(layout.root() == layout.slot(merklize::bin_log(TEST_LEAF_CNT), 0));
+  assert(std::memcmp(computed + (layout.root() << 3), TEST_ROOT, 32) == 0);
+
+  for (size_t lvl = 1, w = TEST_LEAF_CNT >> 1; w > 0; lvl++, w >>= 1) {
+    for (size_t i = 0; i < w; i++) {
+      const uint32_t* node = computed + (layout.slot(lvl, i) << 3);
+      assert(std::memcmp(node, expected + ((w + i) << 3), 32) == 0);
+    }
+  }
+
+  sycl::free(buf_d, q);
+  std::free(computed);
+}
+
+// Asserts that in-place merklization computes same intermediates, as
+// `merklize::merklize` does, irrespective of how many subtrees tree is split
+// into
+void
+test_merklize_inplace(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  merklize_test_tree<1>(q, expected);
+
+  check_merklize_inplace<1>(q, expected);
+  check_merklize_inplace<2>(q, expected);
+  check_merklize_inplace<8>(q, expected);
+
+  std::free(expected);
+
+  std::cout << "passed in-place binary merklization test !" << std::endl;
+}
+
+// Computes top K levels of test binary merkle tree, using N subtrees, each
+// computed in tiles of 2^TILE_LOG leaves, and asserts that they're same as
+// top K levels in `expected`, computed by `merklize::merklize`
+template<size_t N, size_t TILE_LOG>
+void
+check_merklize_top_levels(sycl::queue& q,
+                          const uint32_t* const expected,
+                          const size_t K)
+{
+  const size_t i_size = TEST_LEAF_CNT << 5;
+  const size_t o_size = (1ul << K) << 5;
+
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(i_size));
+  uint32_t* top_h = static_cast<uint32_t*>(std::malloc(o_size));
+  uint32_t* leaves_d = static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* top_d = static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+
+  prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+  q.memcpy(leaves_d, leaves_h, i_size).wait();
+
+  merklize::merklize_top_levels<N, TILE_LOG>(
+    q, TEST_LEAF_CNT, leaves_d, i_size, top_d, o_size, K);
+  merklize::read_top_levels(q, top_d, top_h, K).wait();
+
+  assert(std::memcmp(expected + 8, top_h + 8, o_size - 32) == 0);
+
+  sycl::free(leaves_d, q);
+  sycl::free(top_d, q);
+  std::free(leaves_h);
+  std::free(top_h);
+}
+
+// Asserts that computing only top K levels of tree, produces same nodes, as
+// those computed by `merklize::merklize`, both when just root is requested &
+// when subtree roots need to be combined from many tiles
+void
+test_merklize_top_levels(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  merklize_test_tree<1>(q, expected);
+
+  check_merklize_top_levels<1, 2>(q, expected, 1);
+  check_merklize_top_levels<1, 10>(q, expected, 1);
+  check_merklize_top_levels<2, 3>(q, expected, 4);
+  check_merklize_top_levels<4, 1>(q, expected, 9);
+
+  std::free(expected);
+
+  std::cout << "passed top levels binary merklization test !" << std::endl;
+}
+
+// Asserts that out-of-core merklization, with leaves & intermediates living
+// in host memory, produces same intermediates, as `merklize::merklize` does,
+// both when subtree roots fit in one slice & when they need to be split into
+// slices again
+void
+test_merklize_out_of_core(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* leaves = static_cast<uint32_t*>(std::malloc(size));
+
+  merklize_test_tree<1>(q, expected);
+  prepare_test_leaves(leaves, TEST_LEAF_CNT);
+
+  // slices of 64 leaves
+  merklize::merklize_out_of_core<2>(
+    q, TEST_LEAF_CNT, leaves, computed, 64ul << 7);
+  assert(std::memcmp(expected + 8, computed + 8, size - 32) == 0);
+
+  // slices of 4 leaves
+  merklize::merklize_out_of_core<1>(
+    q, TEST_LEAF_CNT, leaves, computed, 4ul << 7);
+  assert(std::memcmp(expected + 8, computed + 8, size - 32) == 0);
+
+  std::free(expected);
+  std::free(computed);
+  std::free(leaves);
+
+  std::cout << "passed out-of-core binary merklization test !" << std::endl;
+}
+
+// Asserts that incrementally updating test binary merkle tree, after leaves
+// at strictly increasing indices `idx` change, produces same intermediates, as
+// merklizing changed leaves from scratch
+void
+check_merklize_update(sycl::queue& q,
+                      const size_t* const idx,
+                      const size_t dirty_cnt)
+{
+  resident_test_tree tree{ q };
+  const size_t size = tree.size;
+
+  uint32_t* digests_h = static_cast<uint32_t*>(std::malloc(dirty_cnt << 5));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+
+  for (size_t i = 0; i < dirty_cnt; i++) {
+    for (size_t j = 0; j < 8; j++) {
+      const uint32_t w = static_cast<uint32_t>(~((i << 3) + j));
+
+      digests_h[(i << 3) + j] = w;
+      tree.leaves_h[(idx[i] << 3) + j] = w;
+    }
+  }
+
+  merklize::update(q,
+                   TEST_LEAF_CNT,
+                   tree.leaves_d,
+                   tree.intermediates_d,
+                   idx,
+                   digests_h,
+                   dirty_cnt);
+
+  // updated leaves must be written back to device
+  q.memcpy(computed, tree.leaves_d, size).wait();
+  assert(std::memcmp(computed, tree.leaves_h, size) == 0);
+
+  q.memcpy(computed, tree.intermediates_d, size).wait();
+  tree.rebuild();
+
+  assert(std::memcmp(tree.intermediates_h + 8, computed + 8, size - 32) == 0);
+
+  std::free(digests_h);
+  std::free(computed);
+}
+
+// Asserts that incremental update of test binary merkle tree works for various
+// sets of dirty leaves, including ones sharing ancestors & ones touching only
+// leftmost leaves, whose dirty set shrinks to node 0 before reaching root
+void
+test_merklize_update(sycl::queue& q)
+{
+  const size_t first[1] = { 0 };
+  check_merklize_update(q, first, 1);
+
+  const size_t leftmost[4] = { 0, 1, 2, 3 };
+  check_merklize_update(q, leftmost, 4);
+
+  // 0, 1 share parent & 5, 6 share grandparent
+  const size_t scattered[6] = { 0, 1, 5, 6, 500, TEST_LEAF_CNT - 1 };
+  check_merklize_update(q, scattered, 6);
+
+  std::cout << "passed incremental binary merkle tree update test !"
+            << std::endl;
+}
+
+// Asserts that inclusion proofs gathered from test binary merkle tree, which
+// is resident in device memory, hold expected sibling digests
+void
+test_merklize_proofs(sycl::queue& q)
+{
+  const size_t depth = merklize::bin_log(TEST_LEAF_CNT);
+
+  constexpr size_t proof_cnt = 6;
+  const size_t idx[proof_cnt] = { 0, 1, 7, 513, 513, TEST_LEAF_CNT - 1 };
+
+  resident_test_tree tree{ q };
+
+  uint32_t* proofs_h =
+    static_cast<uint32_t*>(std::malloc((proof_cnt * depth) << 5));
+
+  merklize::extract_proofs(q,
+                           TEST_LEAF_CNT,
+                           tree.leaves_d,
+                           tree.intermediates_d,
+                           idx,
+                           proof_cnt,
+                           proofs_h);
+
+  for (size_t j = 0; j < proof_cnt; j++) {
+    const uint32_t* proof = proofs_h + ((j * depth) << 3);
+
+    const uint32_t* leaf = tree.leaves_h + ((idx[j] ^ 1ul) << 3);
+
+    assert(std::memcmp(proof, leaf, 32) == 0);
+
+    size_t m = (TEST_LEAF_CNT + idx[j]) >> 1;
+    for (size_t d = 1; d < depth; d++, m >>= 1) {
+      const uint32_t* sibling = tree.intermediates_h + ((m ^ 1ul) << 3);
+
+      assert(std::memcmp(proof + (d << 3), sibling, 32) == 0);
+    }
+  }
+
+  std::free(proofs_h);
+
+  std::cout << "passed inclusion proof extraction test !" << std::endl;
+}
+
+// Asserts that inclusion proofs gathered from test binary merkle tree verify
+// against expected root, while ones with tampered sibling, leaf index or
+// expected root don't
+void
+test_verify_proofs(sycl::queue& q)
+{
+  const size_t depth = merklize::bin_log(TEST_LEAF_CNT);
+
+  constexpr size_t proof_cnt = 40;
+
+  size_t idx[proof_cnt];
+  for (size_t j = 0; j < proof_cnt; j++) {
+    idx[j] = (j * 37) & (TEST_LEAF_CNT - 1);
+  }
+
+  resident_test_tree tree{ q };
+
+  uint32_t* leaves = static_cast<uint32_t*>(std::malloc(proof_cnt << 5));
+  uint32_t* roots = static_cast<uint32_t*>(std::malloc(proof_cnt << 5));
+  uint32_t* proofs =
+    static_cast<uint32_t*>(std::malloc((proof_cnt * depth) << 5));
+  uint32_t bitmap[(proof_cnt + 31) >> 5];
+
+  merklize::extract_proofs(q,
+                           TEST_LEAF_CNT,
+                           tree.leaves_d,
+                           tree.intermediates_d,
+                           idx,
+                           proof_cnt,
+                           proofs);
+
+  for (size_t j = 0; j < proof_cnt; j++) {
+    std::memcpy(leaves + (j << 3), tree.leaves_h + (idx[j] << 3), 32);
+    std::memcpy(roots + (j << 3), TEST_ROOT, 32);
+  }
+
+  // tamper with 3rd, 17th & 33rd tuples
+  proofs[((2 * depth + 4) << 3) + 1] ^= 1u;
+  idx[16] ^= 2ul;
+  roots[(32 << 3) + 7] ^= 1u;
+
+  merklize::verify_proofs(
+    q, depth, leaves, proofs, idx, roots, proof_cnt, bitmap);
+
+  for (size_t j = 0; j < proof_cnt; j++) {
+    const bool ok = (bitmap[j >> 5] >> (j & 31ul)) & 1u;
+
+    assert(ok == (j != 2 && j != 16 && j != 32));
+  }
+
+  std::free(leaves);
+  std::free(roots);
+  std::free(proofs);
+
+  std::cout << "passed inclusion proof verification test !" << std::endl;
+}
+
+// Asserts that multiproof of a set of leaves of test binary merkle tree holds
+// only required nodes, as expected, while each of them matches resident tree
+void
+test_merklize_multiproof(sycl::queue& q)
+{
+  const size_t depth = merklize::bin_log(TEST_LEAF_CNT);
+
+  resident_test_tree tree{ q };
+
+  uint32_t* proof = static_cast<uint32_t*>(std::malloc(tree.size));
+
+  auto check = [&](const size_t* const idx, const size_t idx_cnt) {
+    const merklize::multiproof_layout layout{ TEST_LEAF_CNT, idx, idx_cnt };
+
+    merklize::extract_multiproof(
+      q, tree.leaves_d, tree.intermediates_d, layout, proof);
+
+    for (size_t j = 0; j < layout.nodes.size(); j++) {
+      const size_t m = layout.nodes[j];
+      const uint32_t* node = m >= TEST_LEAF_CNT
+                               ? tree.leaves_h + ((m - TEST_LEAF_CNT) << 3)
+                               : tree.intermediates_h + (m << 3);
+
+      assert(std::memcmp(proof + (j << 3), node, 32) == 0);
+    }
+
+    return layout;
+  };
+
+  // first subtree of 4 leaves, needs only siblings of its ancestors
+  const size_t clustered[4] = { 0, 1, 2, 3 };
+  const auto layout0 = check(clustered, 4);
+  const std::vector<size_t> expected0 = { 257, 129, 65, 33, 17, 9, 5, 3 };
+  assert(layout0.nodes == expected0);
+
+  // range of 32 leaves, which isn't aligned to a subtree
+  size_t range[32];
+  for (size_t i = 0; i < 32; i++) {
+    range[i] = 100 + i;
+  }
+
+  const auto layout1 = check(range, 32);
+  assert(layout1.nodes.size() < depth * 32 / 8);
+
+  // scattered leaves, where some of them still share siblings
+  const size_t scattered[5] = { 3, 8, 9, 600, TEST_LEAF_CNT - 1 };
+  const auto layout2 = check(scattered, 5);
+  assert(layout2.nodes.size() < depth * 5);
+
+  std::free(proof);
+
+  std::cout << "passed multiproof extraction test !" << std::endl;
+}
+
+// Asserts that range proofs of test binary merkle tree have same layout as
+// multiproofs of same leaves, while they verify against expected root, unless
+// some leaf or proof node is tampered with
+void
+test_merklize_range_proof(sycl::queue& q)
+{
+  resident_test_tree tree{ q };
+
+  uint32_t* slice = static_cast<uint32_t*>(std::malloc(tree.size));
+  uint32_t* proof = static_cast<uint32_t*>(std::malloc(tree.size));
+
+  const size_t ranges[][2] = { { 0, TEST_LEAF_CNT }, { 100, 132 },
+                               { 5, 6 },            { 3, 700 },
+                               { 0, 512 },          { 1023, 1024 } };
+
+  for (auto [a, b] : ranges) {
+    std::vector<size_t> idx(b - a);
+    for (size_t i = a; i < b; i++) {
+      idx[i - a] = i;
+    }
+
+    const auto layout = merklize::range_layout(TEST_LEAF_CNT, a, b);
+    const merklize::multiproof_layout expected{ TEST_LEAF_CNT,
+                                                idx.data(),
+                                                idx.size() };
+    assert(layout.nodes == expected.nodes);
+
+    merklize::extract_multiproof(
+      q, tree.leaves_d, tree.intermediates_d, layout, proof);
+    std::memcpy(slice, tree.leaves_h + (a << 3), (b - a) << 5);
+
+    bool ok = false;
+
+    merklize::verify_range(
+      q, TEST_LEAF_CNT, a, b, slice, proof, TEST_ROOT, &ok);
+    assert(ok);
+
+    slice[(((b - a) >> 1) << 3) + 3] ^= 1u;
+    merklize::verify_range(
+      q, TEST_LEAF_CNT, a, b, slice, proof, TEST_ROOT, &ok);
+    assert(!ok);
+    slice[(((b - a) >> 1) << 3) + 3] ^= 1u;
+
+    if (!layout.nodes.empty()) {
+      proof[((layout.nodes.size() - 1) << 3) + 5] ^= 1u;
+      merklize::verify_range(
+        q, TEST_LEAF_CNT, a, b, slice, proof, TEST_ROOT, &ok);
+      assert(!ok);
+    }
+  }
+
+  std::free(slice);
+  std::free(proof);
+
+  std::cout << "passed range proof test !" << std::endl;
+}
+
+// Computes all intermediates of test binary merkle tree using S systolic
+// stages, and copies them back to `intermediates` ( allocated on host )
+template<size_t S>
+void
+merklize_systolic_test_tree(sycl::queue& q, uint32_t* const intermediates)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* leaves_d = static_cast<uint32_t*>(sycl::malloc_device(size, q));
+  uint32_t* intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+
+  q.memcpy(leaves_d, leaves_h, size).wait();
+  q.memset(intermediates_d, 0, size).wait();
+
+  merklize::merklize_systolic<S>(
+    q, TEST_LEAF_CNT, leaves_d, size, intermediates_d, size);
+
+  q.memcpy(intermediates, intermediates_d, size).wait();
+
+  sycl::free(leaves_d, q);
+  sycl::free(intermediates_d, q);
+  std::free(leaves_h);
+}
+
+// Asserts that systolic merklization produces same intermediates, as
+// `merklize::merklize` does, both when some levels are left for reduction
+// kernel and when every level is computed by its own stage
+void
+test_merklize_systolic(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+
+  merklize_test_tree<1>(q, expected);
+
+  merklize_systolic_test_tree<4>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  merklize_systolic_test_tree<10>(q, computed);
+  assert(std::memcmp(expected, computed, size) == 0);
+
+  std::free(expected);
+  std::free(computed);
+
+  std::cout << "passed systolic binary merklization test !" << std::endl;
+}
+
+// Asserts that merklization, while leaves are streamed from host memory in
+// chunks, produces same intermediates, as `merklize::merklize` does
+void
+test_merklize_streamed(sycl::queue& q)
+{
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(size, q));
+
+  merklize_test_tree<1>(q, expected);
+  prepare_test_leaves(leaves_h, TEST_LEAF_CNT);
+
+  for (size_t chunk_cnt = 2; chunk_cnt <= 16; chunk_cnt <<= 3) {
+    q.memset(intermediates_d, 0, size).wait();
+
+    merklize::merklize_streamed(
+      q, TEST_LEAF_CNT, leaves_h, size, intermediates_d, size, chunk_cnt);
+
+    q.memcpy(computed, intermediates_d, size).wait();
+    assert(std::memcmp(expected, computed, size) == 0);
+  }
+
+  sycl::free(intermediates_d, q);
+  std::free(expected);
+  std::free(computed);
+  std::free(leaves_h);
+
+  std::cout << "passed streamed binary merklization test !" << std::endl;
+}
+
+// Expected root of binary merkle tree with 1000 leaves, built following RFC
+// 6962 split rule, where i-th word of leaves is i
+//
+// $ python3
+// >>> import hashlib, struct
+// >>> h = lambda b: hashlib.sha256(b).digest()
+// >>> def mth(ls):
+// ...   if len(ls) == 1: return ls[0]
+// ...   k = 1 << ((len(ls) - 1).bit_length() - 1)
+// ...   return h(mth(ls[:k]) + mth(ls[k:]))
+// >>> ls = [struct.pack('>8I', *range(i * 8, i * 8 + 8)) for i in range(1000)]
+// >>> struct.unpack('>8I', mth(ls))
+constexpr uint32_t TEST_RFC6962_ROOT[8] = { 0x0128307du, 0xa753e52bu,
+                                            0x6620329cu, 0xa777466eu,
+                                            0x0656b7f6u, 0x255ec0acu,
+                                            0x2f9fc25cu, 0x184a9c8eu };
+
+// Computes all intermediates of binary merkle tree with `leaf_cnt` leaves (
+// see `prepare_test_leaves` ), following RFC 6962 split rule, and copies them
+// back to `intermediates` ( allocated on host, having
+// `merklize::slot_cnt(leaf_cnt)` slots )
+void
+merklize_rfc6962_test_tree(sycl::queue& q,
+                           const size_t leaf_cnt,
+                           uint32_t* const intermediates)
+{
+  const size_t i_size = leaf_cnt << 5;
+  const size_t o_size = merklize::slot_cnt(leaf_cnt) << 5;
+
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(i_size));
+  uint32_t* leaves_d = static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+
+  prepare_test_leaves(leaves_h, leaf_cnt);
+
+  q.memcpy(leaves_d, leaves_h, i_size).wait();
+  q.memset(intermediates_d, 0, o_size).wait();
+
+  merklize::merklize_rfc6962(
+    q, leaf_cnt, leaves_d, i_size, intermediates_d, o_size);
+
+  q.memcpy(intermediates, intermediates_d, o_size).wait();
+
+  sycl::free(leaves_d, q);
+  sycl::free(intermediates_d, q);
+  std::free(leaves_h);
+}
+
+// Asserts that merklization with arbitrary leaf count ( including single leaf
+// ) computes expected root & when leaf count is power of 2, produces same
+// intermediates, as `merklize::merklize` does
+void
+test_merklize_rfc6962(sycl::queue& q)
+{
+  constexpr size_t leaf_cnt = 1000;
+
+  const size_t size = TEST_LEAF_CNT << 5;
+
+  assert(merklize::slot_cnt(TEST_LEAF_CNT) == TEST_LEAF_CNT);
+  assert(merklize::level_width(leaf_cnt, 1) == 500);
+  assert(merklize::level_width(leaf_cnt, 3) == 125);
+  assert(merklize::level_width(leaf_cnt, 4) == 63);
+  assert(merklize::level_cnt(leaf_cnt) == 10);
+
+  uint32_t* expected = static_cast<uint32_t*>(std::malloc(size));
+  uint32_t* computed = static_cast<uint32_t*>(std::malloc(size));
+
+  merklize_test_tree<1>(q, expected);
+  merklize_rfc6962_test_tree(q, TEST_LEAF_CNT, computed);
+  assert(std::memcmp(expected + 8, computed + 8, size - 32) == 0);
+
+  merklize_rfc6962_test_tree(q, leaf_cnt, computed);
+  assert(std::memcmp(computed + 8, TEST_RFC6962_ROOT, 32) == 0);
+
+  // root of tree with single leaf is that leaf itself
+  merklize_rfc6962_test_tree(q, 1, computed);
+  prepare_test_leaves(expected, 1);
+  assert(std::memcmp(computed + 8, expected, 32) == 0);
+
+  std::free(expected);
+  std::free(computed);
+
+  std::cout << "passed RFC 6962 binary merklization test !" << std::endl;
+}
+
+// Asserts that Bitcoin style merklization ( using double SHA256 & duplicating
+// last node of odd width levels ) computes expected roots, for block having
+// only coinbase transaction, for Bitcoin block #100000, having 4 transactions
+//
+// Block root f3e94742aca4b5ef85488dc37c06c3282295ffec960994b2c0d5ac2a25a95766
+//
+// and for tree with 1000 leaves ( see `prepare_test_leaves` ), having multiple
+// odd width levels
+//
+// $ python3
+// >>> import hashlib, struct
+// >>> d = lambda b: hashlib.sha256(hashlib.sha256(b).digest()).digest()
+// >>> ls = [struct.pack('>8I', *range(i * 8, i * 8 + 8)) for i in range(1000)]
+// >>> while len(ls) > 1:
+// ...   ls = ls + ls[-1:] if len(ls) & 1 else ls
+// ...   ls = [d(ls[i] + ls[i + 1]) for i in range(0, len(ls), 2)]
+// >>> struct.unpack('>8I', ls[0])
+void
+test_merklize_sha256d(sycl::queue& q)
+{
+  // transaction identifiers of Bitcoin block #100000, in internal byte order
+  constexpr uint32_t txids[32] = {
+    0x876dd0a3u, 0xef4a2816u, 0xffd1c12au, 0xb649825au, 0x958b0ff3u,
+    0xbb3d6f3eu, 0x1250f13du, 0xdbf0148cu, 0xc40297f7u, 0x30dd7b5au,
+    0x99567eb8u, 0xd27b7875u, 0x8f607507u, 0xc52292d0u, 0x2d403189u,
+    0x5b52f2ffu, 0xc46e239au, 0xb7d28e2cu, 0x019b6d66u, 0xad8fae98u,
+    0xa56ef1f2u, 0x1aeecb94u, 0xd1b17181u, 0x86f05963u, 0x1d0cb837u,
+    0x21529a06u, 0x2d9675b9u, 0x8d6e5c58u, 0x7e4a770fu, 0xc84ed00au,
+    0xbc5a5de0u, 0x4568a6e9u
+  };
+  constexpr uint32_t block_root[8] = { 0x6657a925u, 0x2aacd5c0u, 0xb2940996u,
+                                       0xecff9522u, 0x28c3067cu, 0xc38d4885u,
+                                       0xefb5a4acu, 0x4247e9f3u };
+  constexpr uint32_t test_root[8] = { 0x62deec77u, 0x0061de24u, 0x911be9b1u,
+                                      0xa52ebe95u, 0x5c640449u, 0x1e3a17c3u,
+                                      0x37fc56d4u, 0x763faff1u };
+
+  constexpr size_t leaf_cnt = 1000;
+
+  const size_t i_size = leaf_cnt << 5;
+  const size_t o_size = merklize::slot_cnt(leaf_cnt) << 5;
+
+  uint32_t* leaves_h = static_cast<uint32_t*>(std::malloc(i_size));
+  uint32_t* root_h = static_cast<uint32_t*>(std::malloc(32));
+  uint32_t* leaves_d = static_cast<uint32_t*>(sycl::malloc_device(i_size, q));
+  uint32_t* intermediates_d =
+    static_cast<uint32_t*>(sycl::malloc_device(o_size, q));
+
+  q.memcpy(leaves_d, txids, sizeof(txids)).wait();
+  merklize::merklize_sha256d(
+    q, 4, leaves_d, sizeof(txids), intermediates_d, o_size);
+
+  q.memcpy(root_h, intermediates_d + 8, 32).wait();
+  assert(std::memcmp(root_h, block_root, 32) == 0);
+
+  // block having only coinbase transaction, whose identifier is root
+  merklize::merklize_sha256d(q, 1, leaves_d, 32, intermediates_d, o_size);
+
+  q.memcpy(root_h, intermediates_d + 8, 32).wait();
+  assert(std::memcmp(root_h, txids, 32) == 0);
+
+  prepare_test_leaves(leaves_h, leaf_cnt);
+  q.memcpy(leaves_d, leaves_h, i_size).wait();
+  merklize::merklize_sha256d(
+    q, leaf_cnt, leaves_d, i_size, intermediates_d, o_size);
+
+  q.memcpy(root_h, intermediates_d + 8, 32).wait();
+  assert(std::memcmp(root_h, test_root, 32) == 0);
+
+  sycl::free(leaves_d, q);
+  sycl::free(intermediates_d, q);
+  std::free(leaves_h);
+  std::free(root_h);
+
+  std::cout << "passed Bitcoin style binary merklization test !" << std::endl;
+}
@@ -0,0 +1,193 @@
+#pragma once
+#include "sha256.hpp"
+#include <cassert>
+#include <cstring>
+#include <iostream>
+
+template<sha256::variant v>
+class kernelSHA256VariantTest;
+
+// Asserts that chosen variant of SHA256 compression engine computes same
+// 2-to-1 digest as expected, both with generic ( padded input ) and
+// specialized ( precomputed padding block schedule ) paths, where input ( = 64
+// -bytes ) is
+//
+// $ python3
+// >>> in = [i for i in range(64)]
+template<sha256::variant v>
+void
+test_sha256_variant(sycl::queue& q)
+{
+  // 2-to-1 digest of above input, in terms of 8 message words
+  constexpr uint32_t expected[8] = { 0xfdeab9acu, 0xf3710362u, 0xbd2658cdu,
+                                     0xc9a29e8fu, 0x9c757fcfu, 0x9811603au,
+                                     0x8c447cd1u, 0xd9151108u };
+
+  bool* res_d = static_cast<bool*>(sycl::malloc_device(sizeof(bool), q));
+  bool* res_h = static_cast<bool*>(std::malloc(sizeof(bool)));
+
+  q.single_task<kernelSHA256VariantTest<v>>([=]() {
+    [[intel::fpga_register]] uint32_t in_words[16];
+    [[intel::fpga_register]] uint32_t padded[32];
+    [[intel::fpga_register]] uint32_t hash_state[8];
+    [[intel::fpga_register]] uint32_t msg_schld[sha256::schedule_words(v)];
+
+#pragma unroll 16
+    for (size_t i = 0; i < 16; i++) {
+      const uint32_t b = static_cast<uint32_t>(i << 2);
+      in_words[i] = (b << 24) | ((b + 1) << 16) | ((b + 2) << 8) | (b + 3);
+    }
+
+    sha256::pad_input_message(in_words, padded);
+    sha256::hash<v>(hash_state, msg_schld, padded);
+
+    bool _res = true;
+    for (size_t i = 0; i < 8; i++) {
+      _res &= (hash_state[i] == expected[i]);
+    }
+
+    sha256::hash_2_to_1<v>(hash_state, msg_schld, in_words);
+
+    for (size_t i = 0; i < 8; i++) {
+      _res &= (hash_state[i] == expected[i]);
+    }
+
+    res_d[0] = _res;
+  }).wait();
+
+  q.memcpy(res_h, res_d, sizeof(bool)).wait();
+  assert(res_h[0] == true);
+
+  sycl::free(res_d, q);
+  std::free(res_h);
+}
+
+class kernelSHA256StreamingTest;
+
+// Asserts that streaming SHA256 context computes correct digests of messages
+// of arbitrary length, digested in arbitrary chunks, where messages are
+//
+// $ python3
+// >>> msgs = [b'', b'abc', bytes([i & 0xff for i in range(1000)])]
+void
+test_sha256_streaming(sycl::queue& q)
+{
+  constexpr uint32_t expected[24] = {
+    0xe3b0c442u, 0x98fc1c14u, 0x9afbf4c8u, 0x996fb924u, 0x27ae41e4u,
+    0x649b934cu, 0xa495991bu, 0x7852b855u, 0xba7816bfu, 0x8f01cfeau,
+    0x414140deu, 0x5dae2223u, 0xb00361a3u, 0x96177a9cu, 0xb410ff61u,
+    0xf20015adu, 0xa8af099bu, 0xf2e87860u, 0x9558dbf6u, 0x9d8f88f4u,
+    0xa31040a8u, 0xcf84b549u, 0xa0cfa912u, 0xf12ffc3fu
+  };
+
+  constexpr size_t msg_len = 1000;
+
+  uint8_t* msg_h = static_cast<uint8_t*>(std::malloc(msg_len));
+  uint8_t* msg_d = static_cast<uint8_t*>(sycl::malloc_device(msg_len, q));
+  uint32_t* digests_h = static_cast<uint32_t*>(std::malloc(sizeof(expected)));
+  uint32_t* digests_d =
+    static_cast<uint32_t*>(sycl::malloc_device(sizeof(expected), q));
+
+  for (size_t i = 0; i < msg_len; i++) {
+    msg_h[i] = static_cast<uint8_t>(i);
+  }
+
+  q.memcpy(msg_d, msg_h, msg_len).wait();
+
+  q.single_task<kernelSHA256StreamingTest>([=]() {
+    sycl::device_ptr<uint8_t> msg_ptr{ msg_d };
+    sycl::device_ptr<uint32_t> digests_ptr{ digests_d };
+
+    sha256::context ctx;
+
+    ctx.init();
+    ctx.final(digests_ptr);
+
+    ctx.init();
+    ctx.update(msg_ptr, 0);
+    ctx.update(msg_ptr + 97, 3); // bytes 'a', 'b', 'c'
+    ctx.final(digests_ptr + 8);
+
+    // chunk sizes crossing message block boundaries in different ways
+    constexpr size_t chunks[5] = { 1, 63, 200, 64, 672 };
+
+    ctx.init();
+    for (size_t i = 0, off = 0; i < 5; off += chunks[i], i++) {
+      ctx.update(msg_ptr + off, chunks[i]);
+    }
+    ctx.final(digests_ptr + 16);
+  }).wait();
+
+  q.memcpy(digests_h, digests_d, sizeof(expected)).wait();
+  assert(std::memcmp(digests_h, expected, sizeof(expected)) == 0);
+
+  sycl::free(msg_d, q);
+  sycl::free(digests_d, q);
+  std::free(msg_h);
+  std::free(digests_h);
+}
+
+class kernelSHA256SingleBlockTest;
+
+// Asserts that short messages ( <= 55 -bytes ), padded into single message
+// block, are correctly hashed using just one compression, where messages are
+//
+// $ python3
+// >>> msgs = [bytes(range(32)), bytes(range(55))]
+//
+// First one is padded from its (parsed) words, while latter from its bytes
+void
+test_sha256_single_block(sycl::queue& q)
+{
+  constexpr uint32_t expected[16] = {
+    0x630dcd29u, 0x66c43366u, 0x91125448u, 0xbbb25b4fu, 0xf412a49cu,
+    0x732db2c8u, 0xabc1b858u, 0x1bd710ddu, 0x463eb28eu, 0x72f82e0au,
+    0x96c0a4ccu, 0x53690c57u, 0x1281131fu, 0x672aa229u, 0xe0d45ae5u,
+    0x9b598b59u
+  };
+
+  uint32_t* digests_h = static_cast<uint32_t*>(std::malloc(sizeof(expected)));
+  uint32_t* digests_d =
+    static_cast<uint32_t*>(sycl::malloc_device(sizeof(expected), q));
+
+  q.single_task<kernelSHA256SingleBlockTest>([=]() {
+    [[intel::fpga_register]] uint8_t in_bytes[55];
+    [[intel::fpga_register]] uint32_t in_words[8];
+    [[intel::fpga_register]] uint32_t block[16];
+    [[intel::fpga_register]] uint32_t hash_state[8];
+    [[intel::fpga_register]] uint32_t msg_schld[64];
+
+#pragma unroll
+    for (size_t i = 0; i < 55; i++) {
+      in_bytes[i] = static_cast<uint8_t>(i);
+    }
+
+#pragma unroll 8
+    for (size_t i = 0; i < 8; i++) {
+      const uint32_t b = static_cast<uint32_t>(i << 2);
+      in_words[i] = (b << 24) | ((b + 1) << 16) | ((b + 2) << 8) | (b + 3);
+    }
+
+    sha256::pad_short_message<32>(in_words, block);
+    sha256::hash_single_block(hash_state, msg_schld, block);
+
+    for (size_t i = 0; i < 8; i++) {
+      digests_d[i] = hash_state[i];
+    }
+
+    sycl::private_ptr<uint8_t> in_bytes_ptr{ in_bytes };
+
+    sha256::pad_short_message(in_bytes_ptr, 55, block);
+    sha256::hash_single_block(hash_state, msg_schld, block);
+
+    for (size_t i = 0; i < 8; i++) {
+      digests_d[8 + i] = hash_state[i];
+    }
+  }).wait();
+
+  q.memcpy(digests_h, digests_d, sizeof(expected)).wait();
+  assert(std::memcmp(digests_h, expected, sizeof(expected)) == 0);
+
+  sycl::free(digests_d, q);
+  std::free(digests_h);
+}